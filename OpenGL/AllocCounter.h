@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Счётчик глобальных выделений памяти через operator new.
+// Используется для проверки, что установившийся кадр не обращается к куче
+// (режим --alloc-check). Замены operator new/delete определяются ровно
+// в одной единице трансляции: перед включением заголовка нужно объявить
+// ALLOC_COUNTER_IMPLEMENTATION (по аналогии с STB_IMAGE_IMPLEMENTATION).
+namespace allocCounter {
+	extern std::atomic<size_t> allocations;
+
+	inline size_t count() {
+		return allocations.load(std::memory_order_relaxed);
+	}
+}
+
+#ifdef ALLOC_COUNTER_IMPLEMENTATION
+
+#include <cstdlib>
+#include <new>
+
+namespace allocCounter {
+	std::atomic<size_t> allocations{ 0 };
+
+	static void* allocate(size_t size) {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		if (size == 0) size = 1;
+		void* ptr = std::malloc(size);
+		if (!ptr) throw std::bad_alloc();
+		return ptr;
+	}
+
+	static void* allocateAligned(size_t size, size_t alignment) {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		if (size == 0) size = 1;
+		size = (size + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+		void* ptr = _aligned_malloc(size, alignment);
+#else
+		void* ptr = std::aligned_alloc(alignment, size);
+#endif
+		if (!ptr) throw std::bad_alloc();
+		return ptr;
+	}
+
+	static void freeAligned(void* ptr) {
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+}
+
+void* operator new(size_t size) { return allocCounter::allocate(size); }
+void* operator new[](size_t size) { return allocCounter::allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try { return allocCounter::allocate(size); }
+	catch (...) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try { return allocCounter::allocate(size); }
+	catch (...) { return nullptr; }
+}
+void* operator new(size_t size, std::align_val_t alignment) { return allocCounter::allocateAligned(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocCounter::allocateAligned(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { allocCounter::freeAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { allocCounter::freeAligned(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { allocCounter::freeAligned(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { allocCounter::freeAligned(ptr); }
+
+#endif
@@ -0,0 +1,125 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include "GpuTimer.h"
+
+// Динамическое разрешение: 3D-сцена рендерится во внеэкранный буфер, из
+// которого используется только прямоугольник scale * размер окна. Масштаб
+// подстраивается под измеренное время GPU на проход сцены, затем картинка
+// растягивается на весь экран через glBlitFramebuffer. Буфер выделяется
+// под полный размер окна, поэтому смена масштаба не пересоздаёт текстуры.
+struct DynamicResolution {
+	unsigned int fbo = 0;
+	unsigned int colorTexture = 0;
+	unsigned int depthRenderbuffer = 0;
+	int width = 0;                 // Полный (нативный) размер буфера
+	int height = 0;
+
+	bool enabled = true;
+	float scale = 1.0f;
+	float minScale = 0.5f;
+	float maxScale = 1.0f;
+	float targetMs = 16.6f;        // Бюджет времени на проход сцены
+	float smoothedMs = 0.0f;       // Сглаженное измеренное время
+	int cooldown = 0;              // Кадров до следующей смены масштаба
+
+	GpuTimer timer;                // Время прохода сцены
+
+	int scaledWidth() const { return std::max(1, static_cast<int>(width * scale)); }
+	int scaledHeight() const { return std::max(1, static_cast<int>(height * scale)); }
+};
+
+inline void allocateSceneTarget(DynamicResolution& resolution, int width, int height) {
+	resolution.width = std::max(1, width);
+	resolution.height = std::max(1, height);
+
+	glBindTexture(GL_TEXTURE_2D, resolution.colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, resolution.width, resolution.height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, resolution.depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, resolution.width, resolution.height);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, resolution.fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resolution.colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, resolution.depthRenderbuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "Scene framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+inline void createDynamicResolution(DynamicResolution& resolution, int width, int height) {
+	glGenTextures(1, &resolution.colorTexture);
+	glBindTexture(GL_TEXTURE_2D, resolution.colorTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenRenderbuffers(1, &resolution.depthRenderbuffer);
+	glGenFramebuffers(1, &resolution.fbo);
+	createGpuTimer(resolution.timer);
+
+	allocateSceneTarget(resolution, width, height);
+}
+
+inline void deleteDynamicResolution(DynamicResolution& resolution) {
+	deleteGpuTimer(resolution.timer);
+	glDeleteFramebuffers(1, &resolution.fbo);
+	glDeleteRenderbuffers(1, &resolution.depthRenderbuffer);
+	glDeleteTextures(1, &resolution.colorTexture);
+	resolution.fbo = resolution.colorTexture = resolution.depthRenderbuffer = 0;
+}
+
+// Подстройка масштаба по завершённым замерам предыдущих кадров
+inline void updateResolutionScale(DynamicResolution& resolution) {
+	collectGpuTimer(resolution.timer, [&](double elapsedMs, int) {
+		float ms = static_cast<float>(elapsedMs);
+		resolution.smoothedMs = resolution.smoothedMs == 0.0f ? ms : resolution.smoothedMs * 0.9f + ms * 0.1f;
+	});
+
+	if (!resolution.enabled || resolution.smoothedMs == 0.0f) return;
+	if (resolution.cooldown > 0) {
+		resolution.cooldown--;
+		return;
+	}
+
+	// Время заливки пропорционально числу пикселей, то есть квадрату масштаба
+	float newScale = resolution.scale;
+	if (resolution.smoothedMs > resolution.targetMs * 1.05f) {
+		newScale = resolution.scale * std::max(0.85f, std::sqrt(resolution.targetMs / resolution.smoothedMs));
+	}
+	else if (resolution.smoothedMs < resolution.targetMs * 0.75f) {
+		newScale = resolution.scale * 1.05f;
+	}
+	newScale = std::min(resolution.maxScale, std::max(resolution.minScale, newScale));
+
+	if (std::fabs(newScale - resolution.scale) > 0.005f) {
+		resolution.scale = newScale;
+		// Даём сглаженному времени догнать новый масштаб
+		resolution.cooldown = 15;
+	}
+}
+
+// Начало прохода сцены: рендер в уменьшенный прямоугольник внеэкранного буфера
+inline void beginScenePass(DynamicResolution& resolution) {
+	beginGpuTimer(resolution.timer);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, resolution.fbo);
+	glViewport(0, 0, resolution.scaledWidth(), resolution.scaledHeight());
+}
+
+// Конец прохода сцены: растягиваем результат на экран
+inline void endScenePass(DynamicResolution& resolution, int framebufferWidth, int framebufferHeight) {
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, resolution.fbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, resolution.scaledWidth(), resolution.scaledHeight(),
+		0, 0, framebufferWidth, framebufferHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, framebufferWidth, framebufferHeight);
+
+	endGpuTimer(resolution.timer);
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+// Линейный (bump) аллокатор для временных данных кадра: списки видимых
+// объектов, пакеты отрисовки, отладочный текст. Память выделяется один раз
+// при старте, reset() вызывается после glfwSwapBuffers, и всё, что было
+// выделено за кадр, освобождается разом. Деструкторы объектов не вызываются,
+// поэтому в арене можно хранить только тривиальные типы.
+class FrameArena {
+public:
+	explicit FrameArena(size_t capacity)
+		: base(static_cast<unsigned char*>(std::malloc(capacity))), size(base ? capacity : 0) {
+	}
+
+	~FrameArena() {
+		std::free(base);
+	}
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Возвращает nullptr, если места не хватило; вызывающий код должен
+	// уметь обойтись без арены (например, отрисовать без отсечения).
+	void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+		uintptr_t current = reinterpret_cast<uintptr_t>(base) + offset;
+		uintptr_t aligned = (current + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t newOffset = (aligned - reinterpret_cast<uintptr_t>(base)) + bytes;
+		if (newOffset > size) {
+			if (!overflowReported) {
+				std::cerr << "FrameArena overflow: requested " << bytes << " bytes, capacity " << size << std::endl;
+				overflowReported = true;
+			}
+			return nullptr;
+		}
+		offset = newOffset;
+		if (offset > peak) peak = offset;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	template <typename T>
+	T* allocArray(size_t count) {
+		return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+	}
+
+	// printf-подобное форматирование прямо в арену (без std::string)
+	const char* format(const char* fmt, ...) {
+		va_list args;
+		va_start(args, fmt);
+		va_list argsCopy;
+		va_copy(argsCopy, args);
+		int length = std::vsnprintf(nullptr, 0, fmt, args);
+		va_end(args);
+
+		char* text = nullptr;
+		if (length >= 0) {
+			text = allocArray<char>(static_cast<size_t>(length) + 1);
+		}
+		if (text) {
+			std::vsnprintf(text, static_cast<size_t>(length) + 1, fmt, argsCopy);
+		}
+		va_end(argsCopy);
+		return text ? text : "";
+	}
+
+	void reset() {
+		offset = 0;
+	}
+
+	size_t used() const { return offset; }
+	size_t capacity() const { return size; }
+	size_t highWater() const { return peak; }
+
+private:
+	unsigned char* base;
+	size_t size;
+	size_t offset = 0;
+	size_t peak = 0;
+	bool overflowReported = false;
+};
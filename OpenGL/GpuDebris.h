@@ -0,0 +1,155 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include "MeshRegistry.h"
+#include "MultiDrawIndirect.h"
+
+// Мусор, постоянно хранящийся в буфере GPU: vec4 на объект (позиция и
+// масштаб), индекс в буфере — id мусора на весь эпизод. Буфер заполняется при
+// генерации уровня, а при подборе обнуляется только масштаб подобранных id,
+// поэтому CPU не перебирает мусор каждый кадр.
+//
+// На GL 4.3 compute-шейдер отсекает мусор по пирамиде прохода и сжимает
+// видимые экземпляры в отдельный буфер, считая instanceCount прямо в команде
+// glDrawElementsIndirect. На GL 3.3 рисуется весь буфер одним instanced-вызовом:
+// подобранный мусор вырождается в точку, остальное отсекает клиппер. (GL 3.3
+// не умеет взять число экземпляров из transform feedback без чтения на CPU,
+// поэтому сжатие через transform feedback дало бы задержку или остановку.)
+struct GpuDebris {
+	bool computeCulling = false;
+	unsigned int cullProgram = 0;
+	unsigned int debrisBuffer = 0;    // Все объекты, индекс — id
+	unsigned int visibleBuffer = 0;   // Видимые в проходе (compute)
+	unsigned int commandBuffer = 0;   // DrawElementsIndirectCommand (compute)
+	unsigned int vao = 0;             // Формат реестра + экземпляры (location 3)
+	size_t capacity = 0;
+	size_t count = 0;                 // Занятые id в текущем эпизоде
+
+	GLint planesLocation = -1;
+	GLint countLocation = -1;
+
+	int cullDispatches = 0;
+	int removals = 0;
+};
+
+inline bool gpuDebrisComputeAvailable() {
+#ifdef GL_COMPUTE_SHADER
+	return GLAD_GL_VERSION_4_3 != 0;
+#else
+	return false;
+#endif
+}
+
+// cullProgram — слинкованный compute-шейдер отсечения или 0 для пути GL 3.3
+inline void createGpuDebris(GpuDebris& debris, const MeshRegistry& registry, size_t capacity, unsigned int cullProgram) {
+	debris.capacity = capacity > 0 ? capacity : 1;
+	debris.cullProgram = cullProgram;
+	debris.computeCulling = cullProgram != 0;
+
+	glGenBuffers(1, &debris.debrisBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, debris.debrisBuffer);
+	glBufferData(GL_ARRAY_BUFFER, debris.capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+
+	unsigned int instanceSource = debris.debrisBuffer;
+#ifdef GL_COMPUTE_SHADER
+	if (debris.computeCulling) {
+		glGenBuffers(1, &debris.visibleBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, debris.visibleBuffer);
+		glBufferData(GL_ARRAY_BUFFER, debris.capacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_COPY);
+		instanceSource = debris.visibleBuffer;
+
+		glGenBuffers(1, &debris.commandBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, debris.commandBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+		debris.planesLocation = glGetUniformLocation(cullProgram, "planes");
+		debris.countLocation = glGetUniformLocation(cullProgram, "debrisCount");
+	}
+#endif
+
+	glGenVertexArrays(1, &debris.vao);
+	glBindVertexArray(debris.vao);
+	registry.setupAttributes();
+	glBindBuffer(GL_ARRAY_BUFFER, instanceSource);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+	glBindVertexArray(0);
+}
+
+inline void deleteGpuDebris(GpuDebris& debris) {
+	if (debris.vao) glDeleteVertexArrays(1, &debris.vao);
+	if (debris.debrisBuffer) glDeleteBuffers(1, &debris.debrisBuffer);
+	if (debris.visibleBuffer) glDeleteBuffers(1, &debris.visibleBuffer);
+	if (debris.commandBuffer) glDeleteBuffers(1, &debris.commandBuffer);
+	if (debris.cullProgram) glDeleteProgram(debris.cullProgram);
+	debris = GpuDebris();
+}
+
+// Загрузка мусора нового эпизода: id = индекс в positions
+inline void uploadGpuDebris(GpuDebris& debris, const glm::vec3* positions, size_t count, float scale) {
+	if (!debris.debrisBuffer) return;
+	debris.count = count < debris.capacity ? count : debris.capacity;
+	if (debris.count == 0) return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, debris.debrisBuffer);
+	glm::vec4* data = static_cast<glm::vec4*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, debris.count * sizeof(glm::vec4),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	if (!data) return;
+	for (size_t i = 0; i < debris.count; ++i) {
+		data[i] = glm::vec4(positions[i], scale);
+	}
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
+// Подобранный мусор: обнуляется масштаб одного id (4 байта)
+inline void removeGpuDebris(GpuDebris& debris, uint32_t id) {
+	if (!debris.debrisBuffer || id >= debris.count) return;
+	const float removedScale = 0.0f;
+	glBindBuffer(GL_ARRAY_BUFFER, debris.debrisBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, id * sizeof(glm::vec4) + 3 * sizeof(float), sizeof(float), &removedScale);
+	debris.removals++;
+}
+
+// Отсечение по planes и отрисовка мусора программой drawProgram (она должна
+// читать экземпляры из location 3, см. uniform instanced в шейдерах сцены)
+inline void drawGpuDebris(GpuDebris& debris, const MeshRegistry& registry, const MeshHandle& mesh,
+	const glm::vec4 planes[6], unsigned int drawProgram) {
+	if (debris.count == 0) return;
+
+#ifdef GL_COMPUTE_SHADER
+	if (debris.computeCulling) {
+		// Счётчик экземпляров обнуляется, остальные поля команды — меш куба
+		DrawElementsIndirectCommand command = { static_cast<GLuint>(mesh.indexCount), 0,
+			static_cast<GLuint>(mesh.firstIndex), mesh.baseVertex, 0 };
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, debris.commandBuffer);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+
+		glUseProgram(debris.cullProgram);
+		glUniform4fv(debris.planesLocation, 6, &planes[0].x);
+		glUniform1ui(debris.countLocation, static_cast<GLuint>(debris.count));
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, debris.debrisBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, debris.visibleBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, debris.commandBuffer);
+		glDispatchCompute(static_cast<GLuint>((debris.count + 255) / 256), 1, 1);
+		glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+		debris.cullDispatches++;
+
+		glUseProgram(drawProgram);
+		glBindVertexArray(debris.vao);
+		glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		registry.drawCalls++;
+		return;
+	}
+#endif
+
+	(void)planes;
+	glUseProgram(drawProgram);
+	glBindVertexArray(debris.vao);
+	registry.drawInstanced(mesh, static_cast<GLsizei>(debris.count));
+}
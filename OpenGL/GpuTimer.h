@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+
+// Замер времени GPU (GL_TIME_ELAPSED) без ожидания результата: несколько
+// запросов по кругу, завершённые забираются в следующих кадрах. Если свободного
+// запроса нет, проход просто не замеряется. tag — метка замера, которая
+// возвращается вместе с результатом (например, номер фазы сравнения).
+struct GpuTimer {
+	static const int queryCount = 3;
+	unsigned int queries[queryCount] = {};
+	bool pending[queryCount] = {};
+	int tags[queryCount] = {};
+	int index = 0;
+	bool active = false;    // Между beginGpuTimer и endGpuTimer идёт замер
+};
+
+inline void createGpuTimer(GpuTimer& timer) {
+	glGenQueries(GpuTimer::queryCount, timer.queries);
+}
+
+inline void deleteGpuTimer(GpuTimer& timer) {
+	if (timer.queries[0]) glDeleteQueries(GpuTimer::queryCount, timer.queries);
+	timer = GpuTimer();
+}
+
+inline void beginGpuTimer(GpuTimer& timer, int tag = 0) {
+	timer.active = timer.queries[timer.index] && !timer.pending[timer.index];
+	if (timer.active) {
+		timer.tags[timer.index] = tag;
+		glBeginQuery(GL_TIME_ELAPSED, timer.queries[timer.index]);
+	}
+}
+
+inline void endGpuTimer(GpuTimer& timer) {
+	if (timer.active) {
+		glEndQuery(GL_TIME_ELAPSED);
+		timer.pending[timer.index] = true;
+		timer.active = false;
+	}
+	timer.index = (timer.index + 1) % GpuTimer::queryCount;
+}
+
+// Забирает завершённые замеры: onResult(ms, tag) для каждого
+template <typename Callback>
+inline void collectGpuTimer(GpuTimer& timer, Callback onResult) {
+	for (int i = 0; i < GpuTimer::queryCount; ++i) {
+		if (!timer.pending[i]) continue;
+		GLint available = 0;
+		glGetQueryObjectiv(timer.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) continue;
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(timer.queries[i], GL_QUERY_RESULT, &elapsed);
+		timer.pending[i] = false;
+		onResult(elapsed / 1.0e6, timer.tags[i]);
+	}
+}
@@ -0,0 +1,291 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // windows.h не должен переопределять std::min/std::max
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Бинарный формат уровня (.vclevel). Файл отображается в память целиком и
+// используется на месте: секции — это массивы структур фиксированного размера,
+// поэтому загрузка сводится к mmap и проверке границ, без разбора и без
+// выделения памяти на каждый элемент.
+//
+// Раскладка (little-endian, все смещения от начала файла, выравнивание 8):
+//   LevelHeader
+//   LevelSectionEntry[sectionCount]
+//   данные секций
+//
+// Версия увеличивается при любом несовместимом изменении структур ниже.
+// Файлы собираются из JSON скриптом tools/level_convert.py.
+
+const uint32_t levelMagic = 0x4C564356;   // "VCVL" в little-endian
+const uint32_t levelVersion = 1;
+
+enum LevelSectionType : uint32_t {
+	LevelSectionVertices = 1,    // LevelVertex
+	LevelSectionIndices = 2,     // uint32_t, локальные для меша
+	LevelSectionMeshes = 3,      // LevelMesh
+	LevelSectionLamps = 4,       // LevelLamp
+	LevelSectionObstacles = 5,   // LevelObstacle
+	LevelSectionDebrisSpawns = 6,// LevelDebrisSpawn
+	LevelSectionDebris = 7,      // LevelDebris, фиксированные позиции
+	LevelSectionTextures = 8     // LevelTexture
+};
+
+struct LevelHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sectionCount;
+	uint32_t flags;              // Пока не используется
+	uint64_t fileSize;
+};
+
+struct LevelSectionEntry {
+	uint32_t type;
+	uint32_t elementSize;        // sizeof элемента, проверяется при загрузке
+	uint64_t offset;
+	uint64_t count;
+};
+
+struct LevelVertex {
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+struct LevelMesh {
+	char name[32];               // Строка с завершающим нулём
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t texture;             // Индекс в секции текстур, -1 — без текстуры
+	uint32_t reserved[3];
+};
+
+struct LevelLamp {
+	float position[3];
+	float color[3];
+};
+
+// Препятствие — ось-ориентированный параллелепипед, через который робот не проезжает
+struct LevelObstacle {
+	float min[3];
+	float max[3];
+};
+
+// Область появления мусора: count точек в [min, max], при gridStep > 0 —
+// в узлах сетки с этим шагом
+struct LevelDebrisSpawn {
+	float min[3];
+	float max[3];
+	uint32_t count;
+	float gridStep;
+};
+
+struct LevelDebris {
+	float position[3];
+};
+
+struct LevelTexture {
+	char path[128];              // Путь относительно рабочего каталога, с завершающим нулём
+};
+
+static_assert(sizeof(LevelHeader) == 24, "LevelHeader layout");
+static_assert(sizeof(LevelSectionEntry) == 24, "LevelSectionEntry layout");
+static_assert(sizeof(LevelVertex) == 32, "LevelVertex layout");
+static_assert(sizeof(LevelMesh) == 64, "LevelMesh layout");
+static_assert(sizeof(LevelLamp) == 24, "LevelLamp layout");
+static_assert(sizeof(LevelObstacle) == 24, "LevelObstacle layout");
+static_assert(sizeof(LevelDebrisSpawn) == 32, "LevelDebrisSpawn layout");
+static_assert(sizeof(LevelDebris) == 12, "LevelDebris layout");
+static_assert(sizeof(LevelTexture) == 128, "LevelTexture layout");
+
+// Массив элементов внутри отображённого файла
+template <typename T>
+struct LevelSpan {
+	const T* data = nullptr;
+	size_t count = 0;
+
+	const T* begin() const { return data; }
+	const T* end() const { return data + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	const T& operator[](size_t i) const { return data[i]; }
+};
+
+struct LevelFile {
+	const unsigned char* memory = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+
+	LevelSpan<LevelVertex> vertices;
+	LevelSpan<uint32_t> indices;
+	LevelSpan<LevelMesh> meshes;
+	LevelSpan<LevelLamp> lamps;
+	LevelSpan<LevelObstacle> obstacles;
+	LevelSpan<LevelDebrisSpawn> debrisSpawns;
+	LevelSpan<LevelDebris> debris;
+	LevelSpan<LevelTexture> textures;
+};
+
+inline void closeLevelFile(LevelFile& level) {
+#ifdef _WIN32
+	if (level.memory) UnmapViewOfFile(level.memory);
+	if (level.mapping) CloseHandle(level.mapping);
+	if (level.file != INVALID_HANDLE_VALUE) CloseHandle(level.file);
+#else
+	if (level.memory) munmap(const_cast<unsigned char*>(level.memory), level.size);
+#endif
+	level = LevelFile();
+}
+
+template <typename T>
+inline bool bindLevelSection(const LevelFile& level, const LevelSectionEntry& entry, LevelSpan<T>& span) {
+	if (entry.elementSize != sizeof(T) || entry.offset % alignof(T) != 0 || entry.offset > level.size ||
+		entry.count > (level.size - entry.offset) / sizeof(T)) {
+		return false;
+	}
+	span.data = reinterpret_cast<const T*>(level.memory + entry.offset);
+	span.count = static_cast<size_t>(entry.count);
+	return true;
+}
+
+inline bool levelStringTerminated(const char* text, size_t capacity) {
+	return std::memchr(text, '\0', capacity) != nullptr;
+}
+
+// Проверка ссылок между секциями. Линейна по числу индексов мешей, но не по
+// числу мусора: фиксированные позиции используются как есть.
+inline bool validateLevel(const LevelFile& level) {
+	for (const LevelMesh& mesh : level.meshes) {
+		if (!levelStringTerminated(mesh.name, sizeof(mesh.name)) ||
+			mesh.firstVertex > level.vertices.count || mesh.vertexCount > level.vertices.count - mesh.firstVertex ||
+			mesh.firstIndex > level.indices.count || mesh.indexCount > level.indices.count - mesh.firstIndex ||
+			mesh.texture >= static_cast<int32_t>(level.textures.count) || mesh.texture < -1) {
+			return false;
+		}
+		for (uint32_t i = 0; i < mesh.indexCount; ++i) {
+			if (level.indices[mesh.firstIndex + i] >= mesh.vertexCount) return false;
+		}
+	}
+	for (const LevelTexture& texture : level.textures) {
+		if (!levelStringTerminated(texture.path, sizeof(texture.path))) return false;
+	}
+	return true;
+}
+
+// Отображает файл уровня в память и привязывает секции. При ошибке файл
+// закрывается и возвращается false.
+inline bool openLevelFile(LevelFile& level, const char* path) {
+	closeLevelFile(level);
+
+#ifdef _WIN32
+	level.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER fileSize;
+	if (level.file == INVALID_HANDLE_VALUE || !GetFileSizeEx(level.file, &fileSize) || fileSize.QuadPart == 0) {
+		std::cerr << "Failed to open level: " << path << std::endl;
+		closeLevelFile(level);
+		return false;
+	}
+	level.size = static_cast<size_t>(fileSize.QuadPart);
+	level.mapping = CreateFileMappingA(level.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (level.mapping) {
+		level.memory = static_cast<const unsigned char*>(MapViewOfFile(level.mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+#else
+	int fd = open(path, O_RDONLY);
+	struct stat info;
+	if (fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0) {
+		std::cerr << "Failed to open level: " << path << std::endl;
+		if (fd >= 0) close(fd);
+		return false;
+	}
+	level.size = static_cast<size_t>(info.st_size);
+	void* memory = mmap(nullptr, level.size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // Отображение остаётся действительным после закрытия дескриптора
+	if (memory != MAP_FAILED) {
+		level.memory = static_cast<const unsigned char*>(memory);
+	}
+#endif
+	if (!level.memory) {
+		std::cerr << "Failed to map level: " << path << std::endl;
+		closeLevelFile(level);
+		return false;
+	}
+
+	const LevelHeader* header = reinterpret_cast<const LevelHeader*>(level.memory);
+	if (level.size < sizeof(LevelHeader) || header->magic != levelMagic) {
+		std::cerr << "Not a level file: " << path << std::endl;
+		closeLevelFile(level);
+		return false;
+	}
+	if (header->version != levelVersion) {
+		std::cerr << "Unsupported level version " << header->version << " (expected " << levelVersion << "): " << path << std::endl;
+		closeLevelFile(level);
+		return false;
+	}
+	if (header->fileSize != level.size ||
+		header->sectionCount > (level.size - sizeof(LevelHeader)) / sizeof(LevelSectionEntry)) {
+		std::cerr << "Truncated level file: " << path << std::endl;
+		closeLevelFile(level);
+		return false;
+	}
+
+	const LevelSectionEntry* sections = reinterpret_cast<const LevelSectionEntry*>(level.memory + sizeof(LevelHeader));
+	bool valid = true;
+	for (uint32_t i = 0; i < header->sectionCount && valid; ++i) {
+		const LevelSectionEntry& entry = sections[i];
+		switch (entry.type) {
+		case LevelSectionVertices: valid = bindLevelSection(level, entry, level.vertices); break;
+		case LevelSectionIndices: valid = bindLevelSection(level, entry, level.indices); break;
+		case LevelSectionMeshes: valid = bindLevelSection(level, entry, level.meshes); break;
+		case LevelSectionLamps: valid = bindLevelSection(level, entry, level.lamps); break;
+		case LevelSectionObstacles: valid = bindLevelSection(level, entry, level.obstacles); break;
+		case LevelSectionDebrisSpawns: valid = bindLevelSection(level, entry, level.debrisSpawns); break;
+		case LevelSectionDebris: valid = bindLevelSection(level, entry, level.debris); break;
+		case LevelSectionTextures: valid = bindLevelSection(level, entry, level.textures); break;
+		default: break; // Неизвестные секции пропускаются
+		}
+	}
+	if (!valid || !validateLevel(level)) {
+		std::cerr << "Corrupt level file: " << path << std::endl;
+		closeLevelFile(level);
+		return false;
+	}
+	return true;
+}
+
+inline const LevelMesh* findLevelMesh(const LevelFile& level, const char* name) {
+	for (const LevelMesh& mesh : level.meshes) {
+		if (std::strcmp(mesh.name, name) == 0) return &mesh;
+	}
+	return nullptr;
+}
+
+// Общее число мусора на уровне: фиксированные позиции плюс области появления
+inline size_t levelDebrisCount(const LevelFile& level) {
+	size_t count = level.debris.count;
+	for (const LevelDebrisSpawn& spawn : level.debrisSpawns) {
+		count += spawn.count;
+	}
+	return count;
+}
@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <vector>
+
+// Расположение меша внутри общих буферов реестра
+struct MeshHandle {
+	GLsizei indexCount = 0;
+	size_t firstIndex = 0;   // В индексах, не в байтах
+	GLint baseVertex = 0;
+};
+
+// Реестр статических мешей: все вершины сцены лежат в одном чередующемся
+// VBO (позиция, нормаль, текстурные координаты), все индексы — в одном IBO,
+// и на этот формат вершин приходится один VAO. Меши рисуются через
+// glDrawElementsBaseVertex, поэтому индексы каждого меша остаются локальными.
+// Реестр владеет буферами: они удаляются в release() или в деструкторе.
+class MeshRegistry {
+public:
+	static const int floatsPerVertex = 8;
+
+	MeshRegistry() = default;
+	~MeshRegistry() {
+		release();
+	}
+
+	MeshRegistry(const MeshRegistry&) = delete;
+	MeshRegistry& operator=(const MeshRegistry&) = delete;
+
+	// sourceStride — число float на вершину во входных данных: 8 (позиция,
+	// нормаль, UV) или 6 (без UV, координаты текстуры дополняются нулями)
+	MeshHandle add(const float* vertices, size_t vertexCount, int sourceStride,
+		const unsigned int* indices, size_t indexCount) {
+		MeshHandle handle;
+		handle.indexCount = static_cast<GLsizei>(indexCount);
+		handle.firstIndex = stagingIndices.size();
+		handle.baseVertex = static_cast<GLint>(stagingVertices.size() / floatsPerVertex);
+
+		for (size_t v = 0; v < vertexCount; ++v) {
+			const float* src = vertices + v * sourceStride;
+			for (int i = 0; i < floatsPerVertex; ++i) {
+				stagingVertices.push_back(i < sourceStride ? src[i] : 0.0f);
+			}
+		}
+		stagingIndices.insert(stagingIndices.end(), indices, indices + indexCount);
+		return handle;
+	}
+
+	// Меш только из индексов: вершины берутся из другого буфера (например, потокового)
+	MeshHandle addIndices(const unsigned int* indices, size_t indexCount) {
+		MeshHandle handle;
+		handle.indexCount = static_cast<GLsizei>(indexCount);
+		handle.firstIndex = stagingIndices.size();
+		stagingIndices.insert(stagingIndices.end(), indices, indices + indexCount);
+		return handle;
+	}
+
+	// Загрузка накопленных данных в GPU; после неё add() больше не вызывается
+	void upload() {
+		glGenBuffers(1, &vertexBuffer);
+		glGenBuffers(1, &indexBuffer);
+		glGenVertexArrays(1, &vertexArray);
+
+		glBindVertexArray(vertexArray);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, stagingVertices.size() * sizeof(float), stagingVertices.data(), GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, stagingIndices.size() * sizeof(unsigned int), stagingIndices.data(), GL_STATIC_DRAW);
+
+		setupAttributes();
+		glBindVertexArray(0);
+
+		vertexCount = stagingVertices.size() / floatsPerVertex;
+		indexCount = stagingIndices.size();
+		std::vector<float>().swap(stagingVertices);
+		std::vector<unsigned int>().swap(stagingIndices);
+	}
+
+	// Настраивает атрибуты 0-2 и IBO реестра для текущего VAO. Нужен для VAO,
+	// которые дополняют общий формат своими атрибутами (например, экземплярами).
+	void setupAttributes() const {
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+		// Позиции
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		// Нормали
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		// Текстуры
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, floatsPerVertex * sizeof(float), (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+	}
+
+	void bind() const {
+		glBindVertexArray(vertexArray);
+	}
+
+	void draw(const MeshHandle& mesh) const {
+		drawCalls++;
+		glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+			(void*)(mesh.firstIndex * sizeof(unsigned int)), mesh.baseVertex);
+	}
+
+	void drawInstanced(const MeshHandle& mesh, GLsizei instanceCount) const {
+		drawCalls++;
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+			(void*)(mesh.firstIndex * sizeof(unsigned int)), instanceCount, mesh.baseVertex);
+	}
+
+	// Удаление буферов; должно выполняться, пока контекст OpenGL ещё жив
+	void release() {
+		if (vertexArray) glDeleteVertexArrays(1, &vertexArray);
+		if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+		if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+		vertexArray = vertexBuffer = indexBuffer = 0;
+	}
+
+	unsigned int vao() const { return vertexArray; }
+	unsigned int vbo() const { return vertexBuffer; }
+	unsigned int ibo() const { return indexBuffer; }
+	size_t totalVertices() const { return vertexCount; }
+	size_t totalIndices() const { return indexCount; }
+
+	// Число вызовов отрисовки через реестр (для статистики; сбрасывается снаружи)
+	mutable unsigned int drawCalls = 0;
+
+private:
+	unsigned int vertexArray = 0;
+	unsigned int vertexBuffer = 0;
+	unsigned int indexBuffer = 0;
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+
+	std::vector<float> stagingVertices;
+	std::vector<unsigned int> stagingIndices;
+};
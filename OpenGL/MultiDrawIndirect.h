@@ -0,0 +1,161 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+#include "MeshRegistry.h"
+#include "StreamBuffer.h"
+
+// Отрисовка всей непрозрачной сцены одним glMultiDrawElementsIndirect.
+// Команды (count, instanceCount, firstIndex, baseVertex, baseInstance) и данные
+// каждого экземпляра (матрица модели и материал) пишутся в потоковый буфер:
+// команды читаются как GL_DRAW_INDIRECT_BUFFER, данные — как SSBO.
+//
+// Индекс записи в SSBO передаётся через атрибут с делителем 1, который читается
+// из статического буфера 0, 1, 2, ...: такой атрибут учитывает baseInstance,
+// поэтому не нужен ARB_shader_draw_parameters (хватает GL 4.3).
+
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Раскладка совпадает с std430 в шейдере
+struct IndirectDrawData {
+	glm::mat4 model;
+	glm::vec4 material;
+};
+
+struct MultiDrawScene {
+	bool supported = false;
+	unsigned int program = 0;
+	unsigned int vao = 0;              // Формат реестра + индекс записи (location 4)
+	unsigned int drawIndexBuffer = 0;  // 0, 1, 2, ... maxDraws - 1
+	size_t maxDraws = 0;
+	size_t maxCommands = 0;
+	GLint storageAlignment = 256;      // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+};
+
+// Команды и данные одного кадра, собираемые прямо в потоковом буфере
+struct IndirectBatch {
+	StreamAllocation commandAllocation;
+	StreamAllocation drawAllocation;
+	DrawElementsIndirectCommand* commands = nullptr;
+	IndirectDrawData* draws = nullptr;
+	size_t commandCount = 0;
+	size_t drawCount = 0;
+	size_t maxCommands = 0;
+	size_t maxDraws = 0;
+};
+
+inline bool multiDrawIndirectAvailable() {
+#ifdef GL_SHADER_STORAGE_BUFFER
+	return GLAD_GL_VERSION_4_3 != 0;
+#else
+	return false;
+#endif
+}
+
+// program должен быть уже слинкован; maxDraws — максимум экземпляров за проход
+inline void createMultiDrawScene(MultiDrawScene& scene, const MeshRegistry& registry, unsigned int program,
+	size_t maxDraws, size_t maxCommands) {
+#ifdef GL_SHADER_STORAGE_BUFFER
+	scene.program = program;
+	scene.maxDraws = maxDraws;
+	scene.maxCommands = maxCommands;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &scene.storageAlignment);
+
+	std::vector<GLuint> indices(maxDraws);
+	for (size_t i = 0; i < maxDraws; ++i) {
+		indices[i] = static_cast<GLuint>(i);
+	}
+	glGenBuffers(1, &scene.drawIndexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, scene.drawIndexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+	glGenVertexArrays(1, &scene.vao);
+	glBindVertexArray(scene.vao);
+	registry.setupAttributes();
+
+	glBindBuffer(GL_ARRAY_BUFFER, scene.drawIndexBuffer);
+	glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+	glEnableVertexAttribArray(4);
+	glVertexAttribDivisor(4, 1);
+
+	glBindVertexArray(0);
+	scene.supported = true;
+#else
+	(void)registry;
+	(void)program;
+	(void)maxDraws;
+	(void)maxCommands;
+#endif
+}
+
+inline void deleteMultiDrawScene(MultiDrawScene& scene) {
+	if (scene.vao) glDeleteVertexArrays(1, &scene.vao);
+	if (scene.drawIndexBuffer) glDeleteBuffers(1, &scene.drawIndexBuffer);
+	if (scene.program) glDeleteProgram(scene.program);
+	scene = MultiDrawScene();
+}
+
+inline bool beginIndirectBatch(IndirectBatch& batch, const MultiDrawScene& scene, StreamBuffer& stream) {
+	batch = IndirectBatch();
+	batch.commandAllocation = streamAllocate(stream, scene.maxCommands * sizeof(DrawElementsIndirectCommand), 4);
+	batch.drawAllocation = streamAllocate(stream, scene.maxDraws * sizeof(IndirectDrawData), scene.storageAlignment);
+	if (!batch.commandAllocation.data || !batch.drawAllocation.data) {
+		return false;
+	}
+	batch.commands = static_cast<DrawElementsIndirectCommand*>(batch.commandAllocation.data);
+	batch.draws = static_cast<IndirectDrawData*>(batch.drawAllocation.data);
+	batch.maxCommands = scene.maxCommands;
+	batch.maxDraws = scene.maxDraws;
+	return true;
+}
+
+// Добавляет команду на instanceCount экземпляров меша; возвращает записи,
+// которые нужно заполнить, или nullptr, если место закончилось
+inline IndirectDrawData* addIndirectDraw(IndirectBatch& batch, const MeshHandle& mesh, size_t instanceCount) {
+	if (instanceCount == 0) return nullptr;
+	if (batch.commandCount >= batch.maxCommands || batch.drawCount + instanceCount > batch.maxDraws) return nullptr;
+
+	DrawElementsIndirectCommand& command = batch.commands[batch.commandCount++];
+	command.count = static_cast<GLuint>(mesh.indexCount);
+	command.instanceCount = static_cast<GLuint>(instanceCount);
+	command.firstIndex = static_cast<GLuint>(mesh.firstIndex);
+	command.baseVertex = mesh.baseVertex;
+	command.baseInstance = static_cast<GLuint>(batch.drawCount);
+
+	IndirectDrawData* draws = batch.draws + batch.drawCount;
+	batch.drawCount += instanceCount;
+	return draws;
+}
+
+// Один вызов на все команды кадра; возвращает число вызовов отрисовки (0 или 1)
+inline int submitIndirectBatch(const IndirectBatch& batch, const MultiDrawScene& scene, StreamBuffer& stream) {
+#ifdef GL_SHADER_STORAGE_BUFFER
+	if (batch.commandCount == 0) return 0;
+
+	streamCommit(stream, batch.commandAllocation, batch.commandCount * sizeof(DrawElementsIndirectCommand));
+	streamCommit(stream, batch.drawAllocation, batch.drawCount * sizeof(IndirectDrawData));
+
+	glUseProgram(scene.program);
+	glBindVertexArray(scene.vao);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, stream.buffer, batch.drawAllocation.offset,
+		batch.drawCount * sizeof(IndirectDrawData));
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, stream.buffer);
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)batch.commandAllocation.offset,
+		static_cast<GLsizei>(batch.commandCount), 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	return 1;
+#else
+	(void)batch;
+	(void)scene;
+	(void)stream;
+	return 0;
+#endif
+}
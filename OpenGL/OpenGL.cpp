@@ -8,268 +8,33 @@
 #include <cstdlib>
 #include <ctime>
 #include <sstream> 
+#include <cstring>
+#include <algorithm>
 #define STB_IMAGE_IMPLEMENTATION  
 #include <stb_image.h>  
-
-
-// Шейдеры
-
-const char* vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;       // Позиция вершины
-layout (location = 1) in vec3 aNormal;    // Нормаль вершины
-layout (location = 2) in vec2 aTexCoord;  // Текстурные координаты
-uniform vec3 cursorWorldPos; 
-
-out vec3 FragPos;       // Позиция фрагмента в мировом пространстве
-out vec3 Normal;        // Нормаль фрагмента 
-out vec2 TexCoord;      // Текстурные координаты
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoord = aTexCoord;
-
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+#define ALLOC_COUNTER_IMPLEMENTATION
+#include "AllocCounter.h"
+#include "FrameArena.h"
+#include "PlanarReflection.h"
+#include "DynamicResolution.h"
+#include "StreamBuffer.h"
+#include "MeshRegistry.h"
+#include "MultiDrawIndirect.h"
+#include "Telemetry.h"
+#include "LevelFormat.h"
+#include "ShadowAtlas.h"
+#include "GpuDebris.h"
+#include "Shaders.h"
+#include "Texture.h"
+#include "Simulation.h"
+
+// Лампы уровня сверх MAX_LAMPS из шейдера не используются
+const size_t maxLamps = 8;
+size_t lampCount = 0;
+
+glm::vec3 levelVec3(const float* v) {
+	return glm::vec3(v[0], v[1], v[2]);
 }
-)";
-
-const char* fragmentShaderSource = R"(
-#version 330 core
-
-struct Ray {
-    vec3 origin;
-    vec3 dir;
-};
-
-struct HitInfo {
-    float t;
-    vec3 normal;
-    bool hit;
-};
-
-HitInfo intersectFloor(Ray ray) {
-    HitInfo hit;
-    float t = (0.0 - ray.origin.y) / ray.dir.y;
-    if (t > 0.001) {
-        hit.t = t;
-        hit.normal = vec3(0, 1, 0);
-        hit.hit = true;
-    } else {
-        hit.hit = false;
-    }
-    return hit;
-}
-
-out vec4 FragColor;
-
-in vec3 FragPos;       // Позиция фрагмента
-in vec3 Normal;        // Нормаль фрагмента
-in vec2 TexCoord;      // Текстурные координаты
-
-uniform vec3 lightPos;     // Позиция источника света
-uniform vec3 viewPos;      // Позиция камеры
-uniform vec3 lightColor;   // Цвет света
-uniform vec3 lightDir;     // Направление света
-uniform float cutOff;      // Внутренний угол отсечения
-uniform float outerCutOff; // Внешний угол отсечения 
-
-uniform sampler2D texture1;  // Основная текстура
-uniform samplerCube skybox;  // Карта отражений 
-uniform bool isMirror;
-
-#define NUM_LAMPS 3
-uniform vec3 lampPositions[NUM_LAMPS];
-uniform vec3 lampColors[NUM_LAMPS];
-uniform bool isLamp;
-
-void main() {
-    if (isLamp) {
-        FragColor = vec4(1.0);
-        return;
-    }
-
-	if (isMirror) {
-        Ray ray;
-        ray.origin = FragPos + 0.001 * Normal;
-        ray.dir = reflect(normalize(FragPos - viewPos), normalize(Normal));
-        HitInfo hit = intersectFloor(ray);
-        if (hit.hit) {
-            vec3 hitPoint = ray.origin + ray.dir * hit.t;
-            vec3 lightDirNorm = normalize(lightPos - hitPoint);
-            float diff = max(dot(hit.normal, lightDirNorm), 0.0);
-            vec3 color = vec3(0.7, 0.7, 0.7) * diff + 0.1;
-            FragColor = vec4(color, 1.0);
-        } else {
-            FragColor = vec4(0.3, 0.5, 0.8, 1.0);
-        }
-        return;
-    }
-    
-
-    // Освещение по Фонгу (основной прожектор)
-    vec3 norm = normalize(Normal);
-    vec3 lightDirection = normalize(lightPos - FragPos);
-
-    // Диффузное освещение
-    float diff = max(dot(norm, lightDirection), 0.0);
-
-    // Зеркальное освещение
-    vec3 viewDir = normalize(viewPos - FragPos);
-    vec3 reflectDir = reflect(-lightDirection, norm);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-
-    // Прожектор
-    float theta = dot(normalize(lightDirection), normalize(-lightDir));
-    float epsilon = cutOff - outerCutOff;
-    float intensity = clamp((theta - outerCutOff) / epsilon, 0.0, 1.0);
-
-    vec3 ambient = 0.1 * lightColor;
-    vec3 diffuse = diff * lightColor * intensity;
-    vec3 specular = spec * lightColor * intensity;
-
-    //Освещение от настенных ламп
-    vec3 lampDiffuse = vec3(0.0);
-    vec3 lampSpecular = vec3(0.0);
-    
-    for(int i = 0; i < NUM_LAMPS; i++) {
-        vec3 lampDir = normalize(lampPositions[i] - FragPos);
-        float distance = length(lampPositions[i] - FragPos);
-		float attenuation = 1.0 / (1.0 + 0.1 * distance + 0.05 * (distance * distance));
-        
-        float lampDiff = max(dot(norm, lampDir), 0.0);
-        lampDiffuse += lampDiff * lampColors[i] * attenuation * 1.0;
-        
-        vec3 lampReflectDir = reflect(-lampDir, norm);
-        float lampSpec = pow(max(dot(viewDir, lampReflectDir), 0.0), 32);
-        lampSpecular += lampSpec * lampColors[i] * attenuation * 0.5;
-    }
-
-    vec3 phong = ambient + (diffuse + specular) * intensity + lampDiffuse + lampSpecular;
-
-    // Карта отражений
-    vec3 I = normalize(FragPos - viewPos);
-    vec3 reflection = texture(skybox, reflect(I, norm)).rgb;
-
-    // Итоговый цвет
-    vec3 textureColor = texture(texture1, TexCoord).rgb;
-    vec3 finalColor = mix(phong * textureColor, reflection * 1.5, 0.1);
-
-    FragColor = vec4(finalColor, 1.0);
-
-}
-)";
-
-const char* uiVertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aColor;
-
-out vec3 Color;
-
-uniform mat4 projection;
-uniform mat4 model;
-
-void main() {
-    Color = aColor;
-    gl_Position = projection * model * vec4(aPos, 1.0);
-}
-)";
-
-const char* uiFragmentShaderSource = R"(
-#version 330 core
-in vec3 Color;
-out vec4 FragColor;
-
-void main() {
-    FragColor = vec4(Color, 0.5);
-}
-)";
-
-// Вершины для пола
-float floorVertices[] = {
-	// Позиции           // Нормали         // Текстуры
-	-10.0f, 0.0f, -10.0f,  0.0f, 1.0f, 0.0f,  0.0f, 0.0f,
-	10.0f, 0.0f, -10.0f,  0.0f, 1.0f, 0.0f,  1.0f, 0.0f,
-	10.0f, 0.0f,  10.0f,  0.0f, 1.0f, 0.0f,  1.0f, 1.0f,
-	-10.0f, 0.0f,  10.0f,  0.0f, 1.0f, 0.0f,  0.0f, 1.0f
-};
-
-unsigned int floorIndices[] = {
-	0, 1, 2,
-	2, 3, 0
-};
-
-float WallVertices[] = {
-	// Старые координаты: 5.0f вызывали многократное повторение
-	-10.0f, 0.0f, -10.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
-	 10.0f, 0.0f, -10.0f, 0.0f, 1.0f, 0.0f, 2.0f, 0.0f,
-	 10.0f, 5.0f, -10.0f, 0.0f, 1.0f, 0.0f, 2.0f, 1.0f, 
-	-10.0f, 5.0f, -10.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f
-};
-
-unsigned int WallIndices[] = {
-	0, 1, 2,
-	2, 3, 0
-};
-
-std::vector<glm::vec3> lampPositions = {
-	glm::vec3(-8.0f, 3.0f, -9.8f), 
-	glm::vec3(0.0f, 3.0f, -9.8f),
-	glm::vec3(8.0f, 3.0f, -9.8f)
-};
-float cubeVertices[] = {
-	// Позиции          // Нормали
-	// Задняя грань
-	-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-	 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-	 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-	-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-
-	// Передняя грань
-	-0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-	 0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-	 0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-	-0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,
-
-	// Левая грань
-	-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-	-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-	-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-	-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-
-	// Правая грань
-	 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-	 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-	 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-	 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-
-	 // Нижняя грань
-	 -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-	  0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-	  0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-	 -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-
-	 // Верхняя грань
-	 -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
-	  0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
-	  0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-	 -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f
-};
-
-
-unsigned int cubeIndices[] = {
-	0, 1, 2, 2, 3, 0,  // Задняя грань
-	4, 5, 6, 6, 7, 4,  // Передняя грань
-	8, 9, 10, 10, 11, 8,  // Левая грань
-	12, 13, 14, 14, 15, 12,  // Правая грань
-	16, 17, 18, 18, 19, 16,  // Нижняя грань
-	20, 21, 22, 22, 23, 20   // Верхняя грань
-};
 
 float timerBarVertices[] = {
 	// Позиции           // Цвета (R, G, B)
@@ -284,58 +49,120 @@ unsigned int timerBarIndices[] = {
 	2, 3, 0
 };
 
-float mirrorVertices[] = {
-	// Позиции           // Нормали         // Текстуры
-	-2.0f, 1.0f, -9.99f,  0.0f, 0.0f, 1.0f,  0.0f, 0.0f,
-	 2.0f, 1.0f, -9.99f,  0.0f, 0.0f, 1.0f,  1.0f, 0.0f,
-	 2.0f, 3.0f, -9.99f,  0.0f, 0.0f, 1.0f,  1.0f, 1.0f,
-	-2.0f, 3.0f, -9.99f,  0.0f, 0.0f, 1.0f,  0.0f, 1.0f
-};
-unsigned int mirrorIndices[] = {
-	0, 1, 2,
-	2, 3, 0
-};
-
-// Позиция робота-пылесоса
-glm::vec3 robotPosition(0.0f, 0.5f, 0.0f);
-
 // Камера
 glm::vec3 cameraPosition(0.0f, 3.0f, 5.0f);
 glm::vec3 cameraFront(0.0f, -0.5f, -1.0f);
 glm::vec3 cameraUp(0.0f, 1.0f, 0.0f);
 
-// Объекты для уборки
-std::vector<glm::vec3> objects;
-int score = 0;
-
-// Таймер
-float batteryLife = 100.0f; // Заряд батареи (в процентах)
-
-// Генерация объектов
-void generateObjects(int count) {
-	srand(static_cast<unsigned int>(time(0)));
-	for (int i = 0; i < count; ++i) {
-		float x = static_cast<float>(rand() % 18 - 9);
-		float z = static_cast<float>(rand() % 18 - 9);
-		objects.push_back(glm::vec3(x, 0.2f, z));
-	}
-}
+// Запас арены кадра сверх списков видимого мусора: текст и выравнивание
+const size_t frameArenaSlackBytes = 64 * 1024;
+
+// Параметры симуляции (задаются из командной строки)
+struct SimConfig {
+	const char* levelPath = "levels/default.vclevel";
+	int debrisCount = -1;                 // Количество мусора в эпизоде (-1 — как задано в уровне)
+	unsigned int seed = 0;                // Зерно расстановки мусора (0 — от текущего времени)
+	size_t frameArenaBytes = 0;           // Размер арены временных данных кадра (0 — по количеству мусора)
+	bool allocCheck = false;              // Режим проверки выделений памяти в кадре
+	int allocCheckWarmupFrames = 60;      // Кадры прогрева, которые не учитываются
+	int allocCheckFrames = 600;           // Через сколько кадров завершить проверку
+	int mirrorWidth = 512;                // Разрешение текстуры отражения
+	int mirrorHeight = 256;
+	int mirrorUpdateInterval = 2;         // Обновлять отражение каждый N-й кадр (0 — без отражения)
+	bool dynamicResolution = true;        // Подстраивать разрешение сцены под время кадра
+	float targetSceneMs = 16.6f;          // Бюджет GPU на проход сцены
+	float minResolutionScale = 0.5f;
+	float fixedResolutionScale = 1.0f;    // Масштаб при отключённой подстройке
+	bool debugLines = false;              // Отладочные линии (направление робота, радиус сбора)
+	bool multiDrawIndirect = true;        // Сцена одним glMultiDrawElementsIndirect (если есть GL 4.3)
+	int drawCallBenchmarkFrames = 0;      // Сравнение числа вызовов: N кадров без MDI, затем N с MDI
+	int metricsPort = 0;                  // Порт HTTP-метрик Prometheus на 127.0.0.1 (0 — выключено)
+	bool shadows = true;                  // Карты теней прожектора и ламп
+	int shadowTileSize = 1024;            // Разрешение карты теней одного источника
+	bool shadowCache = true;              // Кэш статической геометрии и пропуск неизменившихся тайлов
+	int shadowBenchmarkFrames = 0;        // Сравнение: N кадров с кэшем теней, затем N без него
+	bool gpuDebris = true;                // Мусор в буфере GPU, отсечение compute-шейдером (GL 4.3)
+	bool gpuDebrisNoCull = false;         // Без GL 4.3 тоже держать мусор в буфере GPU и рисовать его без отсечения
+};
+SimConfig config;
 
-// Проверка столкновений
-void checkCollisions() {
-	for (auto it = objects.begin(); it != objects.end();) {
-		if (glm::distance(robotPosition, *it) < 0.6f) {
-			it = objects.erase(it);
-			score++;
+void parseArguments(int argc, char** argv) {
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+			config.levelPath = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--debris") == 0 && i + 1 < argc) {
+			config.debrisCount = std::max(0, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			config.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--frame-arena-kb") == 0 && i + 1 < argc) {
+			config.frameArenaBytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) * 1024;
+		}
+		else if (std::strcmp(argv[i], "--mirror-res") == 0 && i + 2 < argc) {
+			config.mirrorWidth = std::max(1, std::atoi(argv[++i]));
+			config.mirrorHeight = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--mirror-interval") == 0 && i + 1 < argc) {
+			config.mirrorUpdateInterval = std::max(0, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--target-ms") == 0 && i + 1 < argc) {
+			config.targetSceneMs = std::max(1.0f, static_cast<float>(std::atof(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--min-scale") == 0 && i + 1 < argc) {
+			config.minResolutionScale = std::min(1.0f, std::max(0.1f, static_cast<float>(std::atof(argv[++i]))));
+		}
+		else if (std::strcmp(argv[i], "--fixed-scale") == 0 && i + 1 < argc) {
+			config.dynamicResolution = false;
+			config.fixedResolutionScale = std::min(1.0f, std::max(0.1f, static_cast<float>(std::atof(argv[++i]))));
+		}
+		else if (std::strcmp(argv[i], "--debug-lines") == 0) {
+			config.debugLines = true;
+		}
+		else if (std::strcmp(argv[i], "--no-mdi") == 0) {
+			config.multiDrawIndirect = false;
+		}
+		else if (std::strcmp(argv[i], "--draw-call-benchmark") == 0 && i + 1 < argc) {
+			config.drawCallBenchmarkFrames = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+			config.metricsPort = std::max(0, std::min(65535, std::atoi(argv[++i])));
+		}
+		else if (std::strcmp(argv[i], "--no-shadows") == 0) {
+			config.shadows = false;
+		}
+		else if (std::strcmp(argv[i], "--shadow-res") == 0 && i + 1 < argc) {
+			config.shadowTileSize = std::max(64, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--no-shadow-cache") == 0) {
+			config.shadowCache = false;
+		}
+		else if (std::strcmp(argv[i], "--shadow-benchmark") == 0 && i + 1 < argc) {
+			config.shadowBenchmarkFrames = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (std::strcmp(argv[i], "--no-gpu-culling") == 0) {
+			config.gpuDebris = false;
+		}
+		else if (std::strcmp(argv[i], "--gpu-debris-no-cull") == 0) {
+			config.gpuDebrisNoCull = true;
+		}
+		else if (std::strcmp(argv[i], "--alloc-check") == 0) {
+			config.allocCheck = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-') {
+				config.allocCheckFrames = std::max(config.allocCheckWarmupFrames + 1, std::atoi(argv[++i]));
+			}
 		}
 		else {
-			++it;
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
 		}
 	}
 }
 
-glm::vec3 robotDirection(0.0f, 0.0f, -1.0f); 
-const float robotSpeed = 0.05f; 
+GpuDebris gpuDebris;
+
+// Метрики для эндпоинта телеметрии
+Telemetry telemetry;
 
 // Обработка ввода
 void processInput(GLFWwindow* window) {
@@ -353,11 +180,11 @@ void processInput(GLFWwindow* window) {
 		robotDirection = glm::vec3(rotation * glm::vec4(robotDirection, 0.0f));
 	}
 
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS && !blockedByObstacle(robotPosition + robotDirection * robotSpeed, robotRadius)) {
 		robotPosition += robotDirection * robotSpeed;
 	}
 
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS && !blockedByObstacle(robotPosition - robotDirection * robotSpeed, robotRadius)) {
 		robotPosition -= robotDirection * robotSpeed;
 	}
 
@@ -372,133 +199,190 @@ void processInput(GLFWwindow* window) {
 
 
 // Отображение текста (счетчика)
-void renderText(GLFWwindow* window, const std::string& text) {
-	glfwSetWindowTitle(window, text.c_str());
+void renderText(GLFWwindow* window, const char* text) {
+	glfwSetWindowTitle(window, text);
 }
 
 
-// Проверка ошибок компиляции шейдеров
-void checkShaderCompilation(unsigned int shader, const std::string& type) {
-	int success;
-	char infoLog[1024];
-	if (type == "PROGRAM") {
-		glGetProgramiv(shader, GL_LINK_STATUS, &success);
-		if (!success) {
-			glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-			std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n";
-		}
-	}
-	else {
-		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-		if (!success) {
-			glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-			std::cerr << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n";
-		}
-	}
-}
-
 // Глобальная переменная для текстуры пола
 unsigned int floorTexture;
 unsigned int wallTexture;
 
-// Функция для загрузки текстуры
-unsigned int loadTexture(const char* path) {
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
-
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	// Загрузка изображения с помощью stb_image
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); 
-	unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
+// Статические меши сцены в общем реестре
+struct SceneMeshes {
+	MeshRegistry registry;
+	MeshHandle floor;
+	MeshHandle wall;
+	MeshHandle mirror;
+	MeshHandle cube;
+	MeshHandle timerBar;       // Только индексы, вершины — в потоковом буфере
+	unsigned int debrisVAO = 0; // Формат реестра + данные экземпляров из потокового буфера
+};
 
-	if (data) {
-		GLenum format = GL_RGB;
-		if (nrChannels == 1)
-			format = GL_RED;
-		else if (nrChannels == 3)
-			format = GL_RGB;
-		else if (nrChannels == 4)
-			format = GL_RGBA;
+// Материалы (см. Material во фрагментном шейдере): x — текстура стены вместо
+// текстуры пола, y — лампа без освещения
+const glm::vec4 floorMaterial(0.0f, 0.0f, 0.0f, 0.0f);
+const glm::vec4 wallMaterial(1.0f, 0.0f, 0.0f, 0.0f);
+const glm::vec4 lampMaterial(1.0f, 1.0f, 0.0f, 0.0f);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else {
-		std::cerr << "Failed to load texture: " << path << std::endl;
-	}
+void setMaterial(unsigned int shaderProgram, const glm::vec4& material) {
+	glUniform4f(glGetUniformLocation(shaderProgram, "material"), material.x, material.y, material.z, material.w);
+}
 
-	stbi_image_free(data);
+glm::mat4 robotModelMatrix() {
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), robotPosition);
+	float angle = glm::atan(robotDirection.x, robotDirection.z); 
+	return glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f)); 
+}
 
-	return textureID;
+glm::mat4 lampModelMatrix(const glm::vec3& position) {
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+	return glm::scale(model, glm::vec3(0.2f)); 
 }
 
 // Рендер пола
-void renderFloor(unsigned int shaderProgram, unsigned int floorVAO) {
+void renderFloor(unsigned int shaderProgram, const SceneMeshes& meshes) {
 	glUseProgram(shaderProgram);
 
 	glm::mat4 model = glm::mat4(1.0f);
 	unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
 	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+	setMaterial(shaderProgram, floorMaterial);
 
-	glBindVertexArray(floorVAO);
-	glBindTexture(GL_TEXTURE_2D, floorTexture);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	meshes.registry.bind();
+	meshes.registry.draw(meshes.floor);
 }
 
 // Рендер стены
-void renderWall(unsigned int shaderProgram, unsigned int WallVAO) {
+void renderWall(unsigned int shaderProgram, const SceneMeshes& meshes) {
 	glUseProgram(shaderProgram);
 
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, wallTexture);
-	glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
-
 	glm::mat4 model = glm::mat4(1.0f);
 	unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
 	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+	setMaterial(shaderProgram, wallMaterial);
 
-	glBindVertexArray(WallVAO);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	meshes.registry.bind();
+	meshes.registry.draw(meshes.wall);
 }
 
 // Рендер робота
-void renderRobot(unsigned int shaderProgram, unsigned int cubeVAO) {
+void renderRobot(unsigned int shaderProgram, const SceneMeshes& meshes) {
 	glUseProgram(shaderProgram);
 
-	glm::mat4 model = glm::translate(glm::mat4(1.0f), robotPosition);
-	float angle = glm::atan(robotDirection.x, robotDirection.z); 
-	model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f)); 
+	glm::mat4 model = robotModelMatrix();
 
 	unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
 	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+	setMaterial(shaderProgram, wallMaterial);
+
+	meshes.registry.bind();
+	meshes.registry.draw(meshes.cube);
+}
+
+// Плоскости пирамиды видимости из матрицы projection * view (метод Gribb/Hartmann)
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+	glm::vec4 rowX(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 rowY(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 rowZ(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 rowW(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	planes[0] = rowW + rowX; // Левая
+	planes[1] = rowW - rowX; // Правая
+	planes[2] = rowW + rowY; // Нижняя
+	planes[3] = rowW - rowY; // Верхняя
+	planes[4] = rowW + rowZ; // Ближняя
+	planes[5] = rowW - rowZ; // Дальняя
+
+	for (int i = 0; i < 6; ++i) {
+		planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+	}
+}
+
+bool sphereInFrustum(const glm::vec4 planes[6], const glm::vec3& center, float radius) {
+	for (int i = 0; i < 6; ++i) {
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Отсечение мусора по пирамиде видимости. Список видимых объектов живёт только
+// в пределах кадра; если арена переполнена, возвращаются все объекты.
+const glm::vec3* cullObjects(const std::vector<glm::vec3>& objects, const glm::vec4 cullPlanes[6], FrameArena& arena,
+	size_t& visibleCount) {
+	// Радиус описанной сферы куба с ребром debrisScale
+	float cullRadius = debrisScale * 0.8660254f;
+
+	visibleCount = objects.size();
+	glm::vec3* culled = arena.allocArray<glm::vec3>(objects.size());
+	if (!culled) {
+		return objects.data();
+	}
 
-	glBindVertexArray(cubeVAO);
-	glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+	visibleCount = 0;
+	for (const auto& obj : objects) {
+		if (sphereInFrustum(cullPlanes, obj, cullRadius)) {
+			culled[visibleCount++] = obj;
+		}
+	}
+	return culled;
 }
 
 //Рендер объектов
-void renderObjects(unsigned int shaderProgram, unsigned int cubeVAO, const std::vector<glm::vec3>& objects) {
+void renderObjects(unsigned int shaderProgram, const SceneMeshes& meshes, const std::vector<glm::vec3>& objects,
+	const glm::vec4 cullPlanes[6], FrameArena& arena, StreamBuffer* stream) {
 	glUseProgram(shaderProgram);
-	float scaleFactor = 0.7f; 
+	setMaterial(shaderProgram, wallMaterial);
+
+	// Мусор в буфере GPU: отсечение и список экземпляров строятся там же
+	if (gpuDebris.vao) {
+		unsigned int instancedLoc = glGetUniformLocation(shaderProgram, "instanced");
+		glUniform1i(instancedLoc, 1);
+		drawGpuDebris(gpuDebris, meshes.registry, meshes.cube, cullPlanes, shaderProgram);
+		glUniform1i(instancedLoc, 0);
+		return;
+	}
 
-	for (const auto& obj : objects) {
-		glm::mat4 model = glm::translate(glm::mat4(1.0f), obj);
-		model = glm::scale(model, glm::vec3(scaleFactor)); 
-		unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+	size_t visibleCount = 0;
+	const glm::vec3* visible = cullObjects(objects, cullPlanes, arena, visibleCount);
+
+	// Все видимые объекты одним вызовом: смещение и масштаб пишутся в потоковый буфер
+	if (stream && visibleCount > 0) {
+		StreamAllocation instances = streamAllocate(*stream, visibleCount * sizeof(glm::vec4), sizeof(glm::vec4));
+		if (instances.data) {
+			glm::vec4* instanceData = static_cast<glm::vec4*>(instances.data);
+			for (size_t i = 0; i < visibleCount; ++i) {
+				instanceData[i] = glm::vec4(visible[i], debrisScale);
+			}
+			streamCommit(*stream, instances, instances.size);
+
+			glBindVertexArray(meshes.debrisVAO);
+			glBindBuffer(GL_ARRAY_BUFFER, stream->buffer);
+			glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)instances.offset);
+
+			unsigned int instancedLoc = glGetUniformLocation(shaderProgram, "instanced");
+			glUniform1i(instancedLoc, 1);
+			meshes.registry.drawInstanced(meshes.cube, static_cast<GLsizei>(visibleCount));
+			glUniform1i(instancedLoc, 0);
+			return;
+		}
+	}
 
-		glBindVertexArray(cubeVAO);
-		glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+	unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
+	meshes.registry.bind();
+	for (size_t i = 0; i < visibleCount; ++i) {
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), visible[i]);
+		model = glm::scale(model, glm::vec3(debrisScale)); 
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		meshes.registry.draw(meshes.cube);
 	}
 }
 
-void renderGameOverText(unsigned int shaderProgram, const std::string& message, const glm::mat4& orthoProjection) {
+bool gameOverMessageShown = false;
+
+void renderGameOverText(unsigned int shaderProgram, const char* message, const glm::mat4& orthoProjection) {
 	glUseProgram(shaderProgram);
 
 	unsigned int projLoc = glGetUniformLocation(shaderProgram, "projection");
@@ -511,8 +395,11 @@ void renderGameOverText(unsigned int shaderProgram, const std::string& message,
 	unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
 	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
 
-
-	std::cout << message << std::endl;
+	// Сообщение выводится в консоль один раз за эпизод, а не каждый кадр
+	if (!gameOverMessageShown) {
+		std::cout << message << std::endl;
+		gameOverMessageShown = true;
+	}
 }
 
 unsigned int loadCubemap(std::vector<std::string> faces) {
@@ -541,7 +428,27 @@ unsigned int loadCubemap(std::vector<std::string> faces) {
 	return textureID;
 }
 
-void renderTimerBar(unsigned int uiShaderProgram, unsigned int timerBarVAO, float batteryLife, const glm::mat4& orthoProjection) {
+void renderTimerBar(unsigned int uiShaderProgram, unsigned int timerBarVAO, const SceneMeshes& meshes, float batteryLife,
+	const glm::mat4& orthoProjection, StreamBuffer& stream) {
+	// Геометрия полоски строится заново каждый кадр по текущему заряду
+	const int vertexCount = 4;
+	const size_t stride = 6 * sizeof(float);
+	StreamAllocation vertices = streamAllocate(stream, vertexCount * stride, stride);
+	if (!vertices.data) return;
+
+	float fraction = glm::clamp(batteryLife / 100.0f, 0.0f, 1.0f);
+	float* out = static_cast<float*>(vertices.data);
+	for (int i = 0; i < vertexCount * 6; ++i) {
+		out[i] = timerBarVertices[i];
+	}
+	for (int i = 0; i < vertexCount; ++i) {
+		out[i * 6] *= fraction;
+		// Цвет от зелёного к красному по мере разряда
+		out[i * 6 + 3] = 1.0f - fraction;
+		out[i * 6 + 4] = fraction;
+	}
+	streamCommit(stream, vertices, vertices.size);
+
 	glUseProgram(uiShaderProgram);
 
 	glDisable(GL_DEPTH_TEST);
@@ -550,23 +457,431 @@ void renderTimerBar(unsigned int uiShaderProgram, unsigned int timerBarVAO, floa
 
 	glUniformMatrix4fv(glGetUniformLocation(uiShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(orthoProjection));
 
-	glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(batteryLife / 100.0f, 1.0f, 1.0f));
-	glUniformMatrix4fv(glGetUniformLocation(uiShaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+	glUniformMatrix4fv(glGetUniformLocation(uiShaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
 
+	// Индексы полоски лежат в общем IBO реестра, вершины — в потоковом буфере
+	MeshHandle bar = meshes.timerBar;
+	bar.baseVertex = static_cast<GLint>(vertices.offset / stride);
 	glBindVertexArray(timerBarVAO);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	meshes.registry.draw(bar);
 
 	glDisable(GL_BLEND);
 	glEnable(GL_DEPTH_TEST);
 }
 
-void renderMirror(unsigned int shaderProgram, unsigned int mirrorVAO) {
+// Отладочные линии: направление робота и радиус сбора мусора
+void renderDebugLines(unsigned int uiShaderProgram, unsigned int debugLinesVAO, const glm::mat4& viewProjection, StreamBuffer& stream) {
+	const int circleSegments = 24;
+	const int vertexCount = 2 + circleSegments * 2;
+	const size_t stride = 6 * sizeof(float);
+	StreamAllocation vertices = streamAllocate(stream, vertexCount * stride, stride);
+	if (!vertices.data) return;
+
+	float* out = static_cast<float*>(vertices.data);
+	auto addVertex = [&out](const glm::vec3& pos, const glm::vec3& color) {
+		out[0] = pos.x; out[1] = pos.y; out[2] = pos.z;
+		out[3] = color.x; out[4] = color.y; out[5] = color.z;
+		out += 6;
+	};
+
+	glm::vec3 heading(1.0f, 1.0f, 0.0f);
+	glm::vec3 radius(0.0f, 1.0f, 1.0f);
+	glm::vec3 base = robotPosition + glm::vec3(0.0f, 0.55f, 0.0f);
+	addVertex(base, heading);
+	addVertex(base + robotDirection * 2.0f, heading);
+
+	glm::vec3 ground(robotPosition.x, 0.02f, robotPosition.z);
+	for (int i = 0; i < circleSegments; ++i) {
+		float a0 = glm::radians(360.0f) * i / circleSegments;
+		float a1 = glm::radians(360.0f) * (i + 1) / circleSegments;
+		addVertex(ground + glm::vec3(glm::cos(a0), 0.0f, glm::sin(a0)) * pickupRadius, radius);
+		addVertex(ground + glm::vec3(glm::cos(a1), 0.0f, glm::sin(a1)) * pickupRadius, radius);
+	}
+	streamCommit(stream, vertices, vertices.size);
+
+	glUseProgram(uiShaderProgram);
+	glUniformMatrix4fv(glGetUniformLocation(uiShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+	glUniformMatrix4fv(glGetUniformLocation(uiShaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+
+	glBindVertexArray(debugLinesVAO);
+	glDrawArrays(GL_LINES, static_cast<GLint>(vertices.offset / stride), vertexCount);
+}
+
+void renderMirror(unsigned int shaderProgram, const SceneMeshes& meshes) {
 	glUseProgram(shaderProgram);
 	glm::mat4 model = glm::mat4(1.0f);
 	unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
 	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-	glBindVertexArray(mirrorVAO);
-	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+	setMaterial(shaderProgram, floorMaterial);
+	meshes.registry.bind();
+	meshes.registry.draw(meshes.mirror);
+}
+
+// Рендер лампочек
+void renderLamps(unsigned int shaderProgram, const SceneMeshes& meshes) {
+	glUseProgram(shaderProgram);
+	setMaterial(shaderProgram, lampMaterial);
+	unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
+	meshes.registry.bind();
+	for (size_t i = 0; i < lampCount; ++i) {
+		glm::mat4 model = lampModelMatrix(levelVec3(level.lamps[i].position));
+		glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+		meshes.registry.draw(meshes.cube);
+	}
+}
+
+void setCameraUniforms(unsigned int shaderProgram, const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye) {
+	glUseProgram(shaderProgram);
+	glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+	glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+	glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), eye.x, eye.y, eye.z);
+}
+
+// Число вызовов glMultiDrawElementsIndirect за кадр (вызовы через реестр считает сам реестр)
+unsigned int multiDrawCalls = 0;
+
+// Вся непрозрачная сцена одним glMultiDrawElementsIndirect.
+// Возвращает false, если сцена не помещается в пакет или в потоковом буфере не
+// хватило места. Проверки идут до отсечения, чтобы запасной путь не отсекал дважды.
+bool renderSceneIndirect(const SceneMeshes& meshes, const MultiDrawScene& multiDraw, const glm::vec4 cullPlanes[6],
+	FrameArena& arena, StreamBuffer& stream) {
+	// Мусор из буфера GPU рисуется отдельным косвенным вызовом (см. renderSceneGeometry).
+	// Вместимость проверяется по всему мусору до отсечения: видимых не больше
+	size_t debrisDraws = gpuDebris.vao ? 0 : objects.size();
+	if (4 + lampCount + debrisDraws > multiDraw.maxDraws) {
+		return false;
+	}
+
+	IndirectBatch batch;
+	if (!beginIndirectBatch(batch, multiDraw, stream)) {
+		return false;
+	}
+
+	size_t visibleCount = 0;
+	const glm::vec3* visible = gpuDebris.vao ? nullptr : cullObjects(objects, cullPlanes, arena, visibleCount);
+
+	IndirectDrawData* draw = addIndirectDraw(batch, meshes.floor, 1);
+	draw->model = glm::mat4(1.0f);
+	draw->material = floorMaterial;
+
+	draw = addIndirectDraw(batch, meshes.wall, 1);
+	draw->model = glm::mat4(1.0f);
+	draw->material = wallMaterial;
+
+	draw = addIndirectDraw(batch, meshes.cube, 1);
+	draw->model = robotModelMatrix();
+	draw->material = wallMaterial;
+
+	if (visibleCount > 0) {
+		draw = addIndirectDraw(batch, meshes.cube, visibleCount);
+		for (size_t i = 0; i < visibleCount; ++i) {
+			draw[i].model = glm::scale(glm::translate(glm::mat4(1.0f), visible[i]), glm::vec3(debrisScale));
+			draw[i].material = wallMaterial;
+		}
+	}
+
+	draw = addIndirectDraw(batch, meshes.cube, lampCount);
+	for (size_t i = 0; i < lampCount; ++i) {
+		draw[i].model = lampModelMatrix(levelVec3(level.lamps[i].position));
+		draw[i].material = lampMaterial;
+	}
+
+	multiDrawCalls += submitIndirectBatch(batch, multiDraw, stream);
+	return true;
+}
+
+// Рендер непрозрачной геометрии сцены (без зеркала и UI). Если передан multiDraw,
+// сцена уходит одним glMultiDrawElementsIndirect, иначе — по вызову на объект (GL 3.3).
+void renderSceneGeometry(unsigned int shaderProgram, const SceneMeshes& meshes, const glm::vec4 cullPlanes[6], FrameArena& arena,
+	StreamBuffer* stream, const MultiDrawScene* multiDraw) {
+	if (multiDraw && stream && renderSceneIndirect(meshes, *multiDraw, cullPlanes, arena, *stream)) {
+		if (gpuDebris.vao) {
+			renderObjects(shaderProgram, meshes, objects, cullPlanes, arena, stream);
+		}
+		return;
+	}
+
+	renderFloor(shaderProgram, meshes);
+	renderWall(shaderProgram, meshes);
+	renderRobot(shaderProgram, meshes);
+	renderObjects(shaderProgram, meshes, objects, cullPlanes, arena, stream);
+	renderLamps(shaderProgram, meshes);
+}
+
+// Плоскость и углы зеркала берутся из меша "mirror" уровня (четыре вершины прямоугольника)
+const LevelMesh* mirrorMesh = nullptr;
+glm::vec3 mirrorNormal(0.0f, 0.0f, 1.0f);
+
+glm::vec3 mirrorCorner(int i) {
+	return levelVec3(level.vertices[mirrorMesh->firstVertex + i].position);
+}
+
+// Рендер отражения в текстуру. Возвращает false, если отражение в этом кадре не обновлялось.
+bool updateMirrorReflection(PlanarReflection& reflection, unsigned int shaderProgram, const SceneMeshes& meshes,
+	const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eye, const glm::vec4 mainFrustum[6],
+	FrameArena& arena, StreamBuffer* stream, const MultiDrawScene* multiDraw) {
+	collectReflectionTiming(reflection);
+
+	reflection.framesSinceUpdate++;
+	if (reflection.valid && reflection.framesSinceUpdate < reflection.updateInterval) {
+		return false;
+	}
+
+	glm::vec3 corners[4] = { mirrorCorner(0), mirrorCorner(1), mirrorCorner(2), mirrorCorner(3) };
+	glm::vec3 center = (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f;
+	float mirrorRadius = glm::length(corners[2] - center);
+
+	// Зеркало не видно или камера за ним — отражение не нужно
+	if (glm::dot(eye - center, mirrorNormal) <= 0.0f || !sphereInFrustum(mainFrustum, center, mirrorRadius)) {
+		reflection.skipped++;
+		return false;
+	}
+
+	glm::mat4 mirrorView = view * reflectionMatrix(mirrorNormal, center);
+	glm::vec3 reflectedEye = eye - 2.0f * glm::dot(eye - center, mirrorNormal) * mirrorNormal;
+
+	// Ближняя плоскость совпадает с плоскостью зеркала: стена и всё за зеркалом отсекаются
+	glm::vec4 worldPlane(mirrorNormal, -glm::dot(mirrorNormal, center));
+	glm::vec4 viewPlane = glm::transpose(glm::inverse(mirrorView)) * worldPlane;
+	glm::mat4 mirrorProjection = obliqueProjection(projection, viewPlane);
+
+	glm::vec4 farFrustum[6];
+	extractFrustumPlanes(projection * mirrorView, farFrustum);
+	glm::vec4 cullPlanes[6];
+	mirrorFrustumPlanes(reflectedEye, corners, mirrorNormal, farFrustum[5], cullPlanes);
+
+	beginGpuTimer(reflection.timer);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, reflection.fbo);
+	glViewport(0, 0, reflection.width, reflection.height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	setCameraUniforms(shaderProgram, mirrorView, mirrorProjection, reflectedEye);
+	if (multiDraw) {
+		setCameraUniforms(multiDraw->program, mirrorView, mirrorProjection, reflectedEye);
+	}
+	renderSceneGeometry(shaderProgram, meshes, cullPlanes, arena, stream, multiDraw);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	endGpuTimer(reflection.timer);
+
+	reflection.viewProjection = mirrorProjection * mirrorView;
+	reflection.framesSinceUpdate = 0;
+	reflection.valid = true;
+	reflection.updates++;
+	return true;
+}
+
+// Параметры настенных ламп не меняются, поэтому задаются один раз после линковки
+void setupLampUniforms(unsigned int shaderProgram) {
+	glUseProgram(shaderProgram);
+	char name[64];
+	glUniform1i(glGetUniformLocation(shaderProgram, "lampCount"), static_cast<int>(lampCount));
+	for (size_t i = 0; i < lampCount; ++i) {
+		const LevelLamp& lamp = level.lamps[i];
+		std::snprintf(name, sizeof(name), "lampPositions[%zu]", i);
+		glUniform3fv(glGetUniformLocation(shaderProgram, name), 1, lamp.position);
+
+		std::snprintf(name, sizeof(name), "lampColors[%zu]", i);
+		glUniform3fv(glGetUniformLocation(shaderProgram, name), 1, lamp.color);
+	}
+}
+
+// Прожектор робота
+void setLightUniforms(unsigned int shaderProgram, const glm::vec3& lightPos, const glm::vec3& lightDir) {
+	glUseProgram(shaderProgram);
+	glUniform3f(glGetUniformLocation(shaderProgram, "lightDir"), lightDir.x, lightDir.y, lightDir.z);
+	glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
+
+	float cutOff = glm::cos(glm::radians(55.0f));
+	float outerCutOff = glm::cos(glm::radians(70.0f)); 
+
+	unsigned int cutOffLoc = glGetUniformLocation(shaderProgram, "cutOff");
+	glUniform1f(cutOffLoc, cutOff);
+
+	unsigned int outerCutOffLoc = glGetUniformLocation(shaderProgram, "outerCutOff");
+	glUniform1f(outerCutOffLoc, outerCutOff);
+
+	unsigned int lightColorLoc = glGetUniformLocation(shaderProgram, "lightColor");
+	glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f);
+}
+
+// Источники с картами теней: 0 — прожектор робота, 1.. — настенные лампы
+ShadowLight shadowLights[1 + maxLamps];
+const float spotShadowFov = 140.0f;  // Двойной внешний угол прожектора
+const float lampShadowFov = 120.0f;  // Предельный угол карты лампы
+const float shadowFarPlane = 40.0f;
+// Тени лампы считаются только там, где она даёт не меньше этой доли света
+// (затухание как в шейдере: 1 / (1 + 0.1 d + 0.05 d^2)). Дальше карта не
+// достаёт, и робот, уехавший из этой области, не заставляет её перерисовывать.
+const float lampShadowAttenuation = 0.2f;
+const float shadowCasterHeight = 1.0f;  // Высота робота и мусора над полом
+
+// Положение робота, для которого перерисовывались тени
+glm::vec3 shadowRobotPosition(0.0f), shadowRobotDirection(0.0f);
+
+// Расстояние, на котором свет лампы ослабевает до lampShadowAttenuation
+float lampShadowRange() {
+	float c = 1.0f - 1.0f / lampShadowAttenuation;
+	return (-0.1f + std::sqrt(0.01f - 4.0f * 0.05f * c)) / (2.0f * 0.05f);
+}
+
+// Лампы неподвижны: карта накрывает только освещённую часть пола — пересечение
+// пола с кругом, где лампа светит не слабее lampShadowAttenuation, — и
+// заканчивается на этом расстоянии
+void setupShadowLights() {
+	const LevelMesh* floorMesh = findLevelMesh(level, "floor");
+	glm::vec3 floorMin(1.0e30f), floorMax(-1.0e30f);
+	for (uint32_t i = 0; i < floorMesh->vertexCount; ++i) {
+		glm::vec3 v = levelVec3(level.vertices[floorMesh->firstVertex + i].position);
+		floorMin = glm::min(floorMin, v);
+		floorMax = glm::max(floorMax, v);
+	}
+	float range = lampShadowRange();
+
+	shadowLights[0].tile = 0;
+	shadowLights[0].moving = true;
+	for (size_t i = 0; i < lampCount; ++i) {
+		ShadowLight& light = shadowLights[1 + i];
+		light.tile = static_cast<int>(1 + i);
+		light.position = levelVec3(level.lamps[i].position);
+
+		float height = light.position.y - floorMin.y;
+		float radius = std::sqrt(std::max(0.0f, range * range - height * height));
+		glm::vec3 litMin(glm::max(floorMin.x, light.position.x - radius), floorMin.y, glm::max(floorMin.z, light.position.z - radius));
+		glm::vec3 litMax(glm::min(floorMax.x, light.position.x + radius), floorMin.y + shadowCasterHeight,
+			glm::min(floorMax.z, light.position.z + radius));
+		glm::vec3 target((litMin.x + litMax.x) * 0.5f, floorMin.y, (litMin.z + litMax.z) * 0.5f);
+		glm::vec3 direction = target - light.position;
+		direction = glm::length(direction) > 0.001f ? glm::normalize(direction) : glm::vec3(0.0f, -1.0f, 0.0f);
+
+		// Угол до самого дальнего угла освещённой области (с высотой объектов)
+		float halfAngle = 0.0f;
+		for (int corner = 0; corner < 8; ++corner) {
+			glm::vec3 point((corner & 1) ? litMax.x : litMin.x, (corner & 2) ? litMax.y : litMin.y, (corner & 4) ? litMax.z : litMin.z);
+			glm::vec3 toPoint = point - light.position;
+			if (glm::length(toPoint) < 0.001f) continue;
+			halfAngle = std::max(halfAngle, glm::degrees(std::acos(glm::clamp(glm::dot(direction, glm::normalize(toPoint)), -1.0f, 1.0f))));
+		}
+		float fov = glm::clamp(halfAngle * 2.0f + 2.0f, 10.0f, lampShadowFov);
+
+		light.viewProjection = spotShadowMatrix(light.position, direction, fov, 0.1f, range);
+		extractFrustumPlanes(light.viewProjection, light.planes);
+	}
+}
+
+// Мусор появился заново — все тайлы устарели
+void invalidateShadows() {
+	for (size_t i = 0; i < 1 + lampCount; ++i) {
+		shadowLights[i].dirty = true;
+	}
+}
+
+// Обновление карт теней. Прожектор движется вместе с роботом, поэтому его тайл
+// перерисовывается целиком, но только когда робот сдвинулся. Тайл лампы
+// перерисовывается, только если границы робота пересекают её пирамиду сейчас
+// или пересекали при прошлой перерисовке (тень надо убрать): статическая
+// глубина копируется из кэша, поверх рендерятся робот и мусор.
+// Подобранный мусор всегда рядом с роботом, так что отдельно его не отслеживаем.
+void updateShadows(ShadowAtlas& atlas, unsigned int shadowProgram, const SceneMeshes& meshes, const glm::vec3& lightPos,
+	const glm::vec3& lightDir, FrameArena& arena, StreamBuffer* stream) {
+	collectShadowTiming(atlas);
+	bool cached = atlas.useStaticCache;
+	size_t lightCount = 1 + lampCount;
+
+	bool robotMoved = robotPosition != shadowRobotPosition || robotDirection != shadowRobotDirection;
+	shadowRobotPosition = robotPosition;
+	shadowRobotDirection = robotDirection;
+
+	ShadowLight& spot = shadowLights[0];
+	if (robotMoved || !cached) {
+		spot.position = lightPos;
+		spot.viewProjection = spotShadowMatrix(lightPos, lightDir, spotShadowFov, 0.1f, shadowFarPlane);
+		extractFrustumPlanes(spot.viewProjection, spot.planes);
+		spot.dirty = true;
+	}
+
+	// Сфера вокруг робота с запасом на мусор, который он мог подобрать в этом кадре
+	float casterRadius = 0.87f + pickupRadius + debrisScale * 0.87f;
+	bool anyDirty = spot.dirty;
+	for (size_t i = 1; i < lightCount; ++i) {
+		ShadowLight& light = shadowLights[i];
+		bool inside = sphereInFrustum(light.planes, robotPosition, casterRadius);
+		if (!cached || (robotMoved && (inside || light.casterInside))) {
+			light.dirty = true;
+		}
+		anyDirty = anyDirty || light.dirty;
+	}
+	if (!anyDirty) {
+		atlas.tilesSkipped += static_cast<int>(lightCount);
+		return;
+	}
+
+	beginGpuTimer(atlas.timer, cached ? 0 : 1);
+	glEnable(GL_SCISSOR_TEST);
+	glEnable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(2.0f, 4.0f);
+
+	// Статическая геометрия неподвижных источников рендерится в кэш один раз
+	if (cached) {
+		for (size_t i = 1; i < lightCount; ++i) {
+			ShadowLight& light = shadowLights[i];
+			if (light.staticCached) continue;
+			bindShadowTile(atlas, atlas.staticFbo, light.tile);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			setCameraUniforms(shadowProgram, glm::mat4(1.0f), light.viewProjection, light.position);
+			renderFloor(shadowProgram, meshes);
+			renderWall(shadowProgram, meshes);
+			light.staticCached = true;
+			atlas.staticTileRenders++;
+		}
+	}
+
+	for (size_t i = 0; i < lightCount; ++i) {
+		ShadowLight& light = shadowLights[i];
+		if (!light.dirty) {
+			atlas.tilesSkipped++;
+			continue;
+		}
+
+		bool fromStaticCache = cached && !light.moving;
+		beginShadowTile(atlas, light.tile, fromStaticCache);
+		setCameraUniforms(shadowProgram, glm::mat4(1.0f), light.viewProjection, light.position);
+		if (!fromStaticCache) {
+			renderFloor(shadowProgram, meshes);
+			renderWall(shadowProgram, meshes);
+			atlas.staticTileRenders++;
+		}
+		// Прожектор закреплён на роботе, сам робот его не загораживает
+		if (!light.moving) {
+			renderRobot(shadowProgram, meshes);
+		}
+		renderObjects(shadowProgram, meshes, objects, light.planes, arena, stream);
+
+		light.casterInside = sphereInFrustum(light.planes, robotPosition, casterRadius);
+		light.dirty = false;
+		atlas.tileUpdates++;
+	}
+
+	glDisable(GL_POLYGON_OFFSET_FILL);
+	glDisable(GL_SCISSOR_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	endGpuTimer(atlas.timer);
+}
+
+void setShadowUniforms(unsigned int shaderProgram, const ShadowAtlas& atlas) {
+	glUseProgram(shaderProgram);
+	glUniform1i(glGetUniformLocation(shaderProgram, "shadowsEnabled"), atlas.fbo != 0);
+	char name[64];
+	for (size_t i = 0; i < 1 + lampCount; ++i) {
+		std::snprintf(name, sizeof(name), "shadowMatrices[%zu]", i);
+		glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name), 1, GL_FALSE, glm::value_ptr(shadowLights[i].viewProjection));
+
+		glm::vec4 tile = shadowTileRect(atlas, shadowLights[i].tile);
+		std::snprintf(name, sizeof(name), "shadowTiles[%zu]", i);
+		glUniform4f(glGetUniformLocation(shaderProgram, name), tile.x, tile.y, tile.z, tile.w);
+	}
 }
 
 double cursorX = 0.0, cursorY = 0.0;
@@ -576,7 +891,63 @@ void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos) {
 	cursorY = ypos;
 }
 
-int main() {
+// Размер буфера кадра окна (в пикселях, может отличаться от размера окна на HiDPI)
+int framebufferWidth = 1080, framebufferHeight = 720;
+bool framebufferResized = false;
+
+void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+	framebufferWidth = width;
+	framebufferHeight = height;
+	framebufferResized = true;
+}
+
+// Меш уровня в общий реестр; вершины и индексы читаются прямо из отображённого файла
+MeshHandle addLevelMesh(MeshRegistry& registry, const LevelMesh& mesh) {
+	static_assert(sizeof(LevelVertex) == MeshRegistry::floatsPerVertex * sizeof(float), "LevelVertex matches registry layout");
+	static_assert(sizeof(uint32_t) == sizeof(unsigned int), "Level indices are used as unsigned int");
+	return registry.add(level.vertices[mesh.firstVertex].position, mesh.vertexCount, MeshRegistry::floatsPerVertex,
+		reinterpret_cast<const unsigned int*>(level.indices.data + mesh.firstIndex), mesh.indexCount);
+}
+
+// Загрузка уровня и проверка мешей, без которых сцена не рисуется
+bool loadLevel(const char* path) {
+	if (!openLevelFile(level, path)) {
+		return false;
+	}
+	const char* requiredMeshes[] = { "floor", "wall", "mirror", "cube" };
+	for (const char* name : requiredMeshes) {
+		if (!findLevelMesh(level, name)) {
+			std::cerr << "Level " << path << " has no mesh \"" << name << "\"" << std::endl;
+			return false;
+		}
+	}
+	mirrorMesh = findLevelMesh(level, "mirror");
+	if (mirrorMesh->vertexCount < 4) {
+		std::cerr << "Level " << path << ": mirror must be a quad" << std::endl;
+		return false;
+	}
+	mirrorNormal = glm::normalize(levelVec3(level.vertices[mirrorMesh->firstVertex].normal));
+
+	lampCount = std::min(level.lamps.size(), maxLamps);
+	if (lampCount < level.lamps.size()) {
+		std::cerr << "Level " << path << ": only the first " << maxLamps << " lamps are used" << std::endl;
+	}
+	return true;
+}
+
+// Путь к текстуре меша уровня
+const char* levelTexturePath(const char* meshName) {
+	const LevelMesh* mesh = findLevelMesh(level, meshName);
+	return mesh && mesh->texture >= 0 ? level.textures[mesh->texture].path : "";
+}
+
+int main(int argc, char** argv) {
+	parseArguments(argc, argv);
+	if (!loadLevel(config.levelPath)) {
+		return -1;
+	}
+	// Сколько мусора в эпизоде: из командной строки или из уровня
+	int debrisTotal = config.debrisCount >= 0 ? config.debrisCount : static_cast<int>(levelDebrisCount(level));
 	bool gameOver = false;
 	if (!glfwInit()) return -1;
 
@@ -593,6 +964,9 @@ int main() {
 		return -1;
 	}
 
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+
 	// Компиляция шейдеров
 	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
@@ -610,91 +984,85 @@ int main() {
 	glDeleteShader(vertexShader);
 	glDeleteShader(fragmentShader);
 
-	// Настройка буферов для пола
-	unsigned int floorVAO, floorVBO, floorEBO;
-	glGenVertexArrays(1, &floorVAO);
-	glGenBuffers(1, &floorVBO);
-	glGenBuffers(1, &floorEBO);
-
-	glBindVertexArray(floorVAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, floorVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(floorVertices), floorVertices, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, floorEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(floorIndices), floorIndices, GL_STATIC_DRAW);
-
-	// Позиции
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	// Нормали
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	setupLampUniforms(shaderProgram);
+	setupSamplerUniforms(shaderProgram);
 
-	// Текстура
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	// Все статические меши в общих VBO/IBO
+	SceneMeshes sceneMeshes;
+	sceneMeshes.floor = addLevelMesh(sceneMeshes.registry, *findLevelMesh(level, "floor"));
+	sceneMeshes.wall = addLevelMesh(sceneMeshes.registry, *findLevelMesh(level, "wall"));
+	sceneMeshes.mirror = addLevelMesh(sceneMeshes.registry, *mirrorMesh);
+	sceneMeshes.cube = addLevelMesh(sceneMeshes.registry, *findLevelMesh(level, "cube"));
+	sceneMeshes.timerBar = sceneMeshes.registry.addIndices(timerBarIndices, sizeof(timerBarIndices) / sizeof(unsigned int));
+	sceneMeshes.registry.upload();
 
-	// Настройка буферов для стен
-	unsigned int WallVAO, WallVBO, WallEBO;
-	glGenVertexArrays(1, &WallVAO);
-	glGenBuffers(1, &WallVBO);
-	glGenBuffers(1, &WallEBO);
-
-	glBindVertexArray(WallVAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, WallVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(WallVertices), WallVertices, GL_STATIC_DRAW);
+	glEnable(GL_DEPTH_TEST);
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, WallEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(WallIndices), WallIndices, GL_STATIC_DRAW);
+	// Мусор в буфере GPU; позиции загружаются туда после каждой генерации.
+	// Без compute-шейдеров (GL 3.3) такой мусор рисовался бы целиком в каждом
+	// проходе, поэтому там по умолчанию остаётся отсечение на CPU.
+	if (config.gpuDebris) {
+		unsigned int cullProgram = gpuDebrisComputeAvailable() ? createComputeProgram(debrisCullComputeShaderSource) : 0;
+		if (cullProgram || config.gpuDebrisNoCull) {
+			createGpuDebris(gpuDebris, sceneMeshes.registry, debrisTotal, cullProgram);
+		}
+	}
 
-	// Настройка атрибутов для стен
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
+	// Потоковый буфер для данных, которые меняются каждый кадр.
+	// Данные экземпляров пишутся дважды (основной проход и отражение)
+	// и ещё по разу на каждую карту теней. Мусор из буфера GPU через него
+	// не проходит, тогда в кадре только статические вызовы: пол, стена,
+	// зеркало, робот и лампы.
+	StreamBuffer streamBuffer;
+	size_t maxSceneDraws = (gpuDebris.vao ? 0 : debrisTotal) + lampCount + 16;
+	size_t shadowInstanceBytes = config.shadows ? maxSceneDraws * sizeof(glm::vec4) * (1 + lampCount) : 0;
+	createStreamBuffer(streamBuffer, maxSceneDraws * (sizeof(glm::vec4) + sizeof(IndirectDrawData)) * 2 +
+		shadowInstanceBytes + 64 * 1024);
+
+	// Путь glMultiDrawElementsIndirect: своя вершинная программа, фрагментный шейдер тот же
+	MultiDrawScene multiDrawScene;
+	if (config.multiDrawIndirect && multiDrawIndirectAvailable()) {
+		std::string multiDrawFragmentSource = replaceShaderVersion(fragmentShaderSource, "#version 430 core");
+		unsigned int multiDrawProgram = createShaderProgram(multiDrawVertexShaderSource, multiDrawFragmentSource.c_str());
+		if (multiDrawProgram) {
+			setupLampUniforms(multiDrawProgram);
+			setupSamplerUniforms(multiDrawProgram);
+			createMultiDrawScene(multiDrawScene, sceneMeshes.registry, multiDrawProgram, maxSceneDraws, 8);
+		}
+	}
 
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
+	// Формат реестра с данными экземпляров для мусора (смещение задаётся перед каждым рисованием)
+	glGenVertexArrays(1, &sceneMeshes.debrisVAO);
+	glBindVertexArray(sceneMeshes.debrisVAO);
 
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	sceneMeshes.registry.setupAttributes();
 
-	// Настройка буферов для куба
-	unsigned int cubeVAO, cubeVBO, cubeEBO;
-	glGenVertexArrays(1, &cubeVAO);
-	glGenBuffers(1, &cubeVBO);
-	glGenBuffers(1, &cubeEBO);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer);
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
 
-	glBindVertexArray(cubeVAO);
+	// Настройка полоски таймера: вершины — из потокового буфера, индексы — из реестра
+	unsigned int timerBarVAO;
+	glGenVertexArrays(1, &timerBarVAO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+	glBindVertexArray(timerBarVAO);
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(cubeIndices), cubeIndices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sceneMeshes.registry.ibo());
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
 
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float))); 
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
 	glEnableVertexAttribArray(1);
 
-	glEnable(GL_DEPTH_TEST);
-
-	// Настройка буферов для полоски таймера
-	unsigned int timerBarVAO, timerBarVBO, timerBarEBO;
-	glGenVertexArrays(1, &timerBarVAO);
-	glGenBuffers(1, &timerBarVBO);
-	glGenBuffers(1, &timerBarEBO);
-
-	glBindVertexArray(timerBarVAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, timerBarVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(timerBarVertices), timerBarVertices, GL_STATIC_DRAW);
+	// Отладочные линии (тот же формат вершин, что и у полоски таймера)
+	unsigned int debugLinesVAO;
+	glGenVertexArrays(1, &debugLinesVAO);
+	glBindVertexArray(debugLinesVAO);
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, timerBarEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(timerBarIndices), timerBarIndices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer.buffer);
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
@@ -720,46 +1088,82 @@ int main() {
 	glDeleteShader(uiVertexShader);
 	glDeleteShader(uiFragmentShader);
 
-	// Настройка буферов для зеркала
-	unsigned int mirrorVAO, mirrorVBO, mirrorEBO;
-	glGenVertexArrays(1, &mirrorVAO);
-	glGenBuffers(1, &mirrorVBO);
-	glGenBuffers(1, &mirrorEBO);
-
-	glBindVertexArray(mirrorVAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, mirrorVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(mirrorVertices), mirrorVertices, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mirrorEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(mirrorIndices), mirrorIndices, GL_STATIC_DRAW);
+	// Память под мусор и временные данные кадра выделяется заранее
+	objects.reserve(debrisTotal);
+	objectIds.reserve(debrisTotal);
+	removedDebris.reserve(256);
+
+	// Арена вмещает списки видимого мусора всех проходов кадра: камера, зеркало,
+	// тень прожектора и тени ламп. При переполнении отсечение отключается и
+	// рисуется весь мусор. Мусор в буфере GPU отсекается на GPU и места не занимает.
+	size_t frameArenaBytes = config.frameArenaBytes;
+	if (frameArenaBytes == 0) {
+		size_t culledDebris = gpuDebris.vao ? 0 : static_cast<size_t>(debrisTotal);
+		frameArenaBytes = culledDebris * sizeof(glm::vec3) * (2 + 1 + lampCount) + frameArenaSlackBytes;
+	}
+	FrameArena frameArena(frameArenaBytes);
 
-	// Позиции
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// Нормали
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	// Текстуры
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	// Генерация объектов
+	spawnSeed = config.seed;
+	generateObjects(config.debrisCount);
+	uploadGpuDebris(gpuDebris, objects.data(), objects.size(), debrisScale);
+	floorTexture = loadTexture(levelTexturePath("floor"));
+	wallTexture = loadTexture(levelTexturePath("wall"));
+
+	PlanarReflection mirrorReflection;
+	if (config.mirrorUpdateInterval > 0) {
+		createPlanarReflection(mirrorReflection, config.mirrorWidth, config.mirrorHeight, config.mirrorUpdateInterval);
+	}
 
+	// Атлас теней: тайл прожектора и по тайлу на лампу
+	ShadowAtlas shadowAtlas;
+	unsigned int shadowProgram = 0;
+	if (config.shadows) {
+		shadowProgram = createShaderProgram(shadowVertexShaderSource, shadowFragmentShaderSource);
+	}
+	if (shadowProgram) {
+		createShadowAtlas(shadowAtlas, config.shadowTileSize, static_cast<int>(1 + lampCount));
+		setupShadowLights();
+	}
 
-	// Генерация объектов
-	generateObjects(20);
-	floorTexture = loadTexture("floor-texture.jpg");
-	wallTexture = loadTexture("wall-texture.jpg");
+	// Сравнение прохода теней: [0] — с кэшем, [1] — всё заново каждый кадр
+	int shadowBenchmarkFrames[2] = { 0, 0 };
+	double shadowBenchmarkCpuMs[2] = { 0.0, 0.0 };
+	int shadowBenchmarkTileUpdates[2] = { 0, 0 };
+	int shadowBenchmarkTilesSkipped[2] = { 0, 0 };
+
+	DynamicResolution sceneResolution;
+	createDynamicResolution(sceneResolution, framebufferWidth, framebufferHeight);
+	sceneResolution.enabled = config.dynamicResolution;
+	sceneResolution.targetMs = config.targetSceneMs;
+	sceneResolution.minScale = config.minResolutionScale;
+	sceneResolution.scale = config.dynamicResolution ? 1.0f : config.fixedResolutionScale;
+
+	int shownScore = -1;
+	int frameIndex = 0;
+	size_t lastAllocCount = allocCounter::count();
+	size_t steadyStateAllocs = 0;
+
+	// Сравнение числа вызовов отрисовки: [0] — по вызову на объект, [1] — MDI
+	int benchmarkFrames[2] = { 0, 0 };
+	unsigned long long benchmarkDrawCalls[2] = { 0, 0 };
+	double benchmarkSubmitMs[2] = { 0.0, 0.0 };
+
+	// Эндпоинт метрик работает в своём потоке и читает только атомарные счётчики
+	MetricsServer metricsServer(telemetry);
+	if (config.metricsPort > 0) {
+		metricsServer.start(config.metricsPort);
+	}
+	double lastFrameTime = glfwGetTime();
+	double ticksWindowStart = lastFrameTime;
+	int ticksThisSecond = 0;
 
 	while (!glfwWindowShouldClose(window)) {
 		if (!gameOver) {
 
 			processInput(window);
 
-			glm::vec3 newPosition = robotPosition + robotDirection * robotSpeed;
-
-			if (newPosition.x > -9.5f && newPosition.x < 9.5f && newPosition.z > -9.5f && newPosition.z < 9.5f) {
-				robotPosition = newPosition;
-			}
+			EpisodeState episodeState = stepSimulation();
 
 			// Обновление позиции камеры
 			float cameraDistance = 5.0f;
@@ -773,102 +1177,165 @@ int main() {
 			glm::mat4 view = glm::lookAt(cameraPosition, robotPosition, cameraUp);
 
 
-			checkCollisions();
-
-			// Уменьшение заряда батареи
-			batteryLife -= 0.05f;
-			if (batteryLife <= 0.0f) {
-				gameOver = true;
-				renderText(window, "Пылесос разрядился!");
+			// Подобранный мусор: счётчик телеметрии и гашение в буфере GPU по id
+			telemetry.pickupsTotal.fetch_add(static_cast<uint64_t>(removedDebris.size()), std::memory_order_relaxed);
+			for (uint32_t id : removedDebris) {
+				removeGpuDebris(gpuDebris, id);
 			}
+			removedDebris.clear();
 
 			// Проверка завершения игры
-			if (objects.empty()) {
+			if (episodeState != EpisodeState::Running) {
 				gameOver = true;
-				renderText(window, "Ура, ты все собрал!");
+				telemetry.episodesTotal.fetch_add(1, std::memory_order_relaxed);
+				renderText(window, episodeState == EpisodeState::AllCollected ? "Ура, ты все собрал!" : "Пылесос разрядился!");
 			}
 
-			// Очистка экрана
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			// Ждём, пока освободится область потокового буфера для этого кадра
+			beginStreamFrame(streamBuffer);
 
-			glUseProgram(shaderProgram);
+			// Режим отрисовки сцены (в режиме сравнения первая половина кадров — без MDI)
+			bool useMultiDraw = multiDrawScene.supported &&
+				(config.drawCallBenchmarkFrames == 0 || frameIndex >= config.drawCallBenchmarkFrames);
+			const MultiDrawScene* multiDraw = useMultiDraw ? &multiDrawScene : nullptr;
+			double sceneStartTime = glfwGetTime();
 
-			// Матрицы камеры
-			glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+			// Подгоняем внеэкранный буфер под новый размер окна
+			if (framebufferResized) {
+				allocateSceneTarget(sceneResolution, framebufferWidth, framebufferHeight);
+				framebufferResized = false;
+			}
 
-			unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-			unsigned int projLoc = glGetUniformLocation(shaderProgram, "projection");
+			// Текстуры пола и стены на весь кадр (создание и пересоздание
+			// внеэкранных буферов занимает блок 0)
+			glActiveTexture(GL_TEXTURE3);
+			glBindTexture(GL_TEXTURE_2D, wallTexture);
+			glActiveTexture(GL_TEXTURE4);
+			glBindTexture(GL_TEXTURE_2D, shadowAtlas.depthTexture);
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, floorTexture);
 
-			glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-			glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+			glUseProgram(shaderProgram);
 
+			// Матрицы камеры
+			float aspect = static_cast<float>(std::max(1, framebufferWidth)) / static_cast<float>(std::max(1, framebufferHeight));
+			glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
 
 			// Направление прожектора — по направлению робота
 			glm::vec3 lightDir = glm::normalize(robotDirection);
-			glUniform3f(glGetUniformLocation(shaderProgram, "lightDir"), lightDir.x, lightDir.y, lightDir.z);
 
 			// Позиция света чуть спереди робота
 			glm::vec3 lightPos = robotPosition + lightDir * 0.5f;
-			glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPos.x, lightPos.y, lightPos.z);
-			float cutOff = glm::cos(glm::radians(55.0f));
-			float outerCutOff = glm::cos(glm::radians(70.0f)); 
 
-			unsigned int cutOffLoc = glGetUniformLocation(shaderProgram, "cutOff");
-			glUniform1f(cutOffLoc, cutOff);
+			setLightUniforms(shaderProgram, lightPos, lightDir);
+			if (multiDraw) {
+				setLightUniforms(multiDraw->program, lightPos, lightDir);
+			}
 
-			unsigned int outerCutOffLoc = glGetUniformLocation(shaderProgram, "outerCutOff");
-			glUniform1f(outerCutOffLoc, outerCutOff);
+			// Карты теней (тайлы, рядом с которыми ничего не двигалось, не перерисовываются)
+			if (shadowAtlas.fbo) {
+				int shadowPhase = config.shadowBenchmarkFrames > 0 && frameIndex >= config.shadowBenchmarkFrames ? 1 : 0;
+				shadowAtlas.useStaticCache = config.shadowCache && shadowPhase == 0;
+				double shadowStartTime = glfwGetTime();
+				int tileUpdatesBefore = shadowAtlas.tileUpdates;
+				int tilesSkippedBefore = shadowAtlas.tilesSkipped;
+				updateShadows(shadowAtlas, shadowProgram, sceneMeshes, lightPos, lightDir, frameArena, &streamBuffer);
+				int phase = shadowAtlas.useStaticCache ? 0 : 1;
+				shadowBenchmarkFrames[phase]++;
+				shadowBenchmarkCpuMs[phase] += (glfwGetTime() - shadowStartTime) * 1000.0;
+				shadowBenchmarkTileUpdates[phase] += shadowAtlas.tileUpdates - tileUpdatesBefore;
+				shadowBenchmarkTilesSkipped[phase] += shadowAtlas.tilesSkipped - tilesSkippedBefore;
+				if (config.shadowBenchmarkFrames > 0 && frameIndex + 1 >= config.shadowBenchmarkFrames * 2) {
+					glfwSetWindowShouldClose(window, 1);
+				}
+
+				setShadowUniforms(shaderProgram, shadowAtlas);
+				if (multiDraw) {
+					setShadowUniforms(multiDraw->program, shadowAtlas);
+				}
+			}
 
+			glm::vec4 frustumPlanes[6];
+			extractFrustumPlanes(projection * view, frustumPlanes);
+
+			// Рендер отражения в текстуру (не каждый кадр)
+			if (mirrorReflection.fbo) {
+				updateMirrorReflection(mirrorReflection, shaderProgram, sceneMeshes, view, projection, cameraPosition,
+					frustumPlanes, frameArena, &streamBuffer, multiDraw);
+			}
 
-			unsigned int viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
-			glUniform3f(viewPosLoc, cameraPosition.x, cameraPosition.y, cameraPosition.z);
+			updateResolutionScale(sceneResolution);
 
-			unsigned int lightColorLoc = glGetUniformLocation(shaderProgram, "lightColor");
-			glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f);
+			// Очистка экрана (сцена рендерится в уменьшенный внеэкранный буфер)
+			beginScenePass(sceneResolution);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-			// Рендер пола
-			renderFloor(shaderProgram, floorVAO);
+			setCameraUniforms(shaderProgram, view, projection, cameraPosition);
+			if (multiDraw) {
+				setCameraUniforms(multiDraw->program, view, projection, cameraPosition);
+			}
 
-			// Рендер стены
-			renderWall(shaderProgram, WallVAO);
+			// Рендер пола, стены, робота, объектов и лампочек
+			renderSceneGeometry(shaderProgram, sceneMeshes, frustumPlanes, frameArena, &streamBuffer, multiDraw);
 
 			// Рендер зеркала
 			glUniform1i(glGetUniformLocation(shaderProgram, "isMirror"), 1);
-			renderMirror(shaderProgram, mirrorVAO);
+			glUniform1i(glGetUniformLocation(shaderProgram, "hasReflection"), mirrorReflection.valid ? 1 : 0);
+			if (mirrorReflection.valid) {
+				glActiveTexture(GL_TEXTURE2);
+				glBindTexture(GL_TEXTURE_2D, mirrorReflection.colorTexture);
+				glActiveTexture(GL_TEXTURE0);
+				glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "reflectionViewProjection"), 1, GL_FALSE,
+					glm::value_ptr(mirrorReflection.viewProjection));
+			}
+			renderMirror(shaderProgram, sceneMeshes);
 			glUniform1i(glGetUniformLocation(shaderProgram, "isMirror"), 0);
 
-			// Рендер робота-пылесоса
-			renderRobot(shaderProgram, cubeVAO);
+			if (config.debugLines) {
+				renderDebugLines(uiShaderProgram, debugLinesVAO, projection * view, streamBuffer);
+			}
 
-			// Рендер объектов
-			renderObjects(shaderProgram, cubeVAO, objects);
+			// Растягиваем сцену на экран, UI рисуется уже в нативном разрешении
+			endScenePass(sceneResolution, framebufferWidth, framebufferHeight);
 
 			// Ортографическая проекция для UI
 			glm::mat4 orthoProjection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
 
-			// Рендер лампочек
-			glUniform1i(glGetUniformLocation(shaderProgram, "isLamp"), 1);
-			for (const auto& pos : lampPositions) {
-				glm::mat4 model = glm::translate(glm::mat4(1.0f), pos);
-				model = glm::scale(model, glm::vec3(0.2f)); 
-				glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-				glBindVertexArray(cubeVAO);
-				glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-			}
-			glUniform1i(glGetUniformLocation(shaderProgram, "isLamp"), 0);
-
 			// Рендер полоски таймера
-			renderTimerBar(uiShaderProgram, timerBarVAO, batteryLife, orthoProjection);
-
-
-			glUseProgram(shaderProgram);
-			for (int i = 0; i < lampPositions.size(); ++i) {
-				std::string posName = "lampPositions[" + std::to_string(i) + "]";
-				glUniform3f(glGetUniformLocation(shaderProgram, posName.c_str()),
-					lampPositions[i].x, lampPositions[i].y, lampPositions[i].z);
+			renderTimerBar(uiShaderProgram, timerBarVAO, sceneMeshes, batteryLife, orthoProjection, streamBuffer);
+
+			// Область потокового буфера этого кадра освободится, когда GPU выполнит его команды
+			endStreamFrame(streamBuffer);
+
+			// Статистика вызовов отрисовки и времени отправки команд
+			unsigned int frameDrawCalls = sceneMeshes.registry.drawCalls + multiDrawCalls;
+			sceneMeshes.registry.drawCalls = 0;
+			multiDrawCalls = 0;
+
+			// Метрики: только атомарные записи, цикл рендера не ждёт сервер
+			telemetry.ticksTotal.fetch_add(1, std::memory_order_relaxed);
+			telemetry.drawCallsTotal.fetch_add(frameDrawCalls, std::memory_order_relaxed);
+			telemetry.frameDrawCalls.store(frameDrawCalls, std::memory_order_relaxed);
+			telemetry.debrisRemaining.store(static_cast<uint32_t>(objects.size()), std::memory_order_relaxed);
+			telemetry.batteryLevel.store(std::max(0.0f, batteryLife), std::memory_order_relaxed);
+			telemetry.coverage.store(static_cast<float>(coveredCells) / (coverageGridSize * coverageGridSize),
+				std::memory_order_relaxed);
+			ticksThisSecond++;
+			if (config.drawCallBenchmarkFrames > 0) {
+				int phase = useMultiDraw ? 1 : 0;
+				benchmarkFrames[phase]++;
+				benchmarkDrawCalls[phase] += frameDrawCalls;
+				benchmarkSubmitMs[phase] += (glfwGetTime() - sceneStartTime) * 1000.0;
+				if (frameIndex + 1 >= config.drawCallBenchmarkFrames * 2 || (phase == 0 && !multiDrawScene.supported &&
+					frameIndex + 1 >= config.drawCallBenchmarkFrames)) {
+					glfwSetWindowShouldClose(window, 1);
+				}
+			}
 
-				std::string colorName = "lampColors[" + std::to_string(i) + "]";
-				glUniform3f(glGetUniformLocation(shaderProgram, colorName.c_str()), 0.8f, 0.7f, 0.6f);
+			// Счётчик в заголовке окна обновляется только при изменении
+			if (!gameOver && score != shownScore) {
+				renderText(window, frameArena.format("Vacuum Cleaner Simulator - Собрано: %d / %d", score, debrisTotal));
+				shownScore = score;
 			}
 
 			glfwSwapBuffers(window);
@@ -876,6 +1343,7 @@ int main() {
 		}
 		else {
 			// Очистка экрана
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 			// Ортографическая проекция для UI
@@ -890,22 +1358,126 @@ int main() {
 			// Проверка нажатия клавиши R для перезапуска
 			if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
 				gameOver = false;
-				batteryLife = 100.0f;
-				score = 0;
-				objects.clear();
-				generateObjects(20);
+				shownScore = -1;
+				gameOverMessageShown = false;
+				invalidateShadows();
+				resetEpisode(config.debrisCount);
+				uploadGpuDebris(gpuDebris, objects.data(), objects.size(), debrisScale);
 			}
 		}
+
+		// Время кадра и частота шагов симуляции
+		double frameEndTime = glfwGetTime();
+		telemetry.framesTotal.fetch_add(1, std::memory_order_relaxed);
+		telemetry.frameTimeMs.observe((frameEndTime - lastFrameTime) * 1000.0);
+		lastFrameTime = frameEndTime;
+		if (frameEndTime - ticksWindowStart >= 1.0) {
+			telemetry.ticksPerSecond.store(static_cast<float>(ticksThisSecond / (frameEndTime - ticksWindowStart)),
+				std::memory_order_relaxed);
+			ticksThisSecond = 0;
+			ticksWindowStart = frameEndTime;
+		}
+
+		// Временные данные кадра больше не нужны
+		frameArena.reset();
+
+		// Проверка: в установившемся режиме кадр не должен обращаться к куче
+		if (config.allocCheck) {
+			size_t allocs = allocCounter::count();
+			if (frameIndex >= config.allocCheckWarmupFrames && allocs != lastAllocCount) {
+				steadyStateAllocs += allocs - lastAllocCount;
+				std::cerr << "Heap allocation in frame " << frameIndex << ": " << (allocs - lastAllocCount) << std::endl;
+			}
+			lastAllocCount = allocs;
+			if (frameIndex + 1 >= config.allocCheckFrames) {
+				glfwSetWindowShouldClose(window, 1);
+			}
+		}
+		++frameIndex;
+	}
+
+	if (config.drawCallBenchmarkFrames > 0) {
+		const char* names[2] = { "per-object (GL 3.3)", "multi-draw indirect" };
+		std::cout << "Draw-call benchmark, " << debrisTotal << " debris:" << std::endl;
+		for (int phase = 0; phase < 2; ++phase) {
+			if (benchmarkFrames[phase] == 0) {
+				std::cout << "  " << names[phase] << ": not available" << std::endl;
+				continue;
+			}
+			std::cout << "  " << names[phase] << ": " << benchmarkFrames[phase] << " frames, "
+				<< static_cast<double>(benchmarkDrawCalls[phase]) / benchmarkFrames[phase] << " draw calls/frame, "
+				<< benchmarkSubmitMs[phase] / benchmarkFrames[phase] << " ms CPU/frame" << std::endl;
+		}
 	}
 
-	glDeleteVertexArrays(1, &floorVAO);
-	glDeleteBuffers(1, &floorVBO);
-	glDeleteBuffers(1, &floorEBO);
+	metricsServer.stop();
+	deleteMultiDrawScene(multiDrawScene);
 
-	glDeleteVertexArrays(1, &cubeVAO);
-	glDeleteBuffers(1, &cubeVBO);
-	glDeleteBuffers(1, &cubeEBO);
+	if (gpuDebris.vao) {
+		std::cout << "GPU debris: " << (gpuDebris.computeCulling ? "compute culling" : "GL 3.3 instanced, no culling")
+			<< ", " << gpuDebris.cullDispatches << " cull dispatches, " << gpuDebris.removals << " removals" << std::endl;
+		deleteGpuDebris(gpuDebris);
+	}
+
+	if (shadowAtlas.fbo) {
+		std::cout << "Shadows: " << shadowAtlas.tileUpdates << " tile updates, " << shadowAtlas.tilesSkipped
+			<< " skipped, " << shadowAtlas.staticTileRenders << " static geometry renders, "
+			<< shadowAtlas.tileCount << " tiles of " << shadowAtlas.tileSize << "x" << shadowAtlas.tileSize << std::endl;
+		const char* names[2] = { "static cache", "no cache" };
+		for (int phase = 0; phase < 2; ++phase) {
+			if (shadowBenchmarkFrames[phase] == 0) continue;
+			std::cout << "  " << names[phase] << ": " << shadowBenchmarkFrames[phase] << " frames, "
+				<< shadowBenchmarkCpuMs[phase] / shadowBenchmarkFrames[phase] << " ms CPU/frame";
+			// Доля тайлов, взятых с прошлого кадра, — выигрыш кэша
+			int tiles = shadowBenchmarkTileUpdates[phase] + shadowBenchmarkTilesSkipped[phase];
+			std::cout << ", " << static_cast<double>(shadowBenchmarkTileUpdates[phase]) / shadowBenchmarkFrames[phase]
+				<< " tile updates/frame, " << (tiles > 0 ? 100.0 * shadowBenchmarkTilesSkipped[phase] / tiles : 0.0)
+				<< "% tiles skipped";
+			if (shadowAtlas.timedPasses[phase] > 0) {
+				// Кадры без перерисовки не замеряются, поэтому время GPU делится на все кадры фазы
+				std::cout << ", GPU " << shadowAtlas.gpuTimeMs[phase] / shadowBenchmarkFrames[phase] << " ms/frame";
+			}
+			std::cout << std::endl;
+		}
+		deleteShadowAtlas(shadowAtlas);
+	}
+	if (shadowProgram) {
+		glDeleteProgram(shadowProgram);
+	}
+
+	// Буферы реестра удаляются до уничтожения контекста
+	sceneMeshes.registry.release();
+	glDeleteVertexArrays(1, &sceneMeshes.debrisVAO);
+	glDeleteVertexArrays(1, &timerBarVAO);
+	glDeleteVertexArrays(1, &debugLinesVAO);
+	if (streamBuffer.fenceWaits > 0) {
+		std::cout << "Stream buffer: waited for GPU " << streamBuffer.fenceWaits << " time(s)" << std::endl;
+	}
+	deleteStreamBuffer(streamBuffer);
+
+	if (mirrorReflection.fbo) {
+		std::cout << "Mirror reflection: " << mirrorReflection.updates << " updates, " << mirrorReflection.skipped
+			<< " skipped (not visible), " << mirrorReflection.width << "x" << mirrorReflection.height
+			<< " every " << mirrorReflection.updateInterval << " frame(s)";
+		if (mirrorReflection.timedUpdates > 0) {
+			std::cout << ", avg GPU " << mirrorReflection.gpuTimeMs / mirrorReflection.timedUpdates << " ms";
+		}
+		std::cout << std::endl;
+		deletePlanarReflection(mirrorReflection);
+	}
+
+	std::cout << "Scene resolution scale: " << sceneResolution.scale << " (" << sceneResolution.scaledWidth() << "x"
+		<< sceneResolution.scaledHeight() << "), scene pass " << sceneResolution.smoothedMs << " ms" << std::endl;
+	deleteDynamicResolution(sceneResolution);
 
 	glfwTerminate();
+	closeLevelFile(level);
+
+	if (config.allocCheck) {
+		std::cout << "Alloc check: " << steadyStateAllocs << " heap allocations in "
+			<< (frameIndex - config.allocCheckWarmupFrames) << " steady-state frames, arena peak "
+			<< frameArena.highWater() << " bytes" << std::endl;
+		return steadyStateAllocs == 0 ? 0 : 1;
+	}
 	return 0;
 }
\ No newline at end of file
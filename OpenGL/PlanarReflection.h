@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include "GpuTimer.h"
+
+// Планарное отражение: сцена рендерится из отражённой камеры в текстуру
+// пониженного разрешения, которую затем сэмплирует шейдер зеркала.
+struct PlanarReflection {
+	unsigned int fbo = 0;
+	unsigned int colorTexture = 0;
+	unsigned int depthRenderbuffer = 0;
+	int width = 0;
+	int height = 0;
+
+	int updateInterval = 1;         // Обновлять каждый N-й кадр (0 — отключено)
+	int framesSinceUpdate = 0;
+	bool valid = false;             // В текстуре есть хотя бы одно отражение
+	glm::mat4 viewProjection{ 1.0f }; // Матрица, с которой была отрендерена текстура
+
+	// Статистика для подбора разрешения и частоты обновления
+	GpuTimer timer;
+	int updates = 0;
+	int skipped = 0;
+	int timedUpdates = 0;
+	double gpuTimeMs = 0.0;
+};
+
+inline bool createPlanarReflection(PlanarReflection& reflection, int width, int height, int updateInterval) {
+	reflection.width = width;
+	reflection.height = height;
+	reflection.updateInterval = updateInterval;
+
+	glGenTextures(1, &reflection.colorTexture);
+	glBindTexture(GL_TEXTURE_2D, reflection.colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenRenderbuffers(1, &reflection.depthRenderbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, reflection.depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+	glGenFramebuffers(1, &reflection.fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, reflection.fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, reflection.colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, reflection.depthRenderbuffer);
+
+	bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!complete) {
+		std::cerr << "Reflection framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	createGpuTimer(reflection.timer);
+	return complete;
+}
+
+inline void deletePlanarReflection(PlanarReflection& reflection) {
+	deleteGpuTimer(reflection.timer);
+	glDeleteFramebuffers(1, &reflection.fbo);
+	glDeleteRenderbuffers(1, &reflection.depthRenderbuffer);
+	glDeleteTextures(1, &reflection.colorTexture);
+	reflection = PlanarReflection();
+}
+
+// Забирает результат предыдущего замера без ожидания GPU
+inline void collectReflectionTiming(PlanarReflection& reflection) {
+	collectGpuTimer(reflection.timer, [&](double ms, int) {
+		reflection.gpuTimeMs += ms;
+		reflection.timedUpdates++;
+	});
+}
+
+// Матрица отражения относительно плоскости, заданной нормалью и точкой
+inline glm::mat4 reflectionMatrix(const glm::vec3& normal, const glm::vec3& point) {
+	float d = -glm::dot(normal, point);
+	glm::mat4 m(1.0f);
+	m[0][0] = 1.0f - 2.0f * normal.x * normal.x;
+	m[1][0] = -2.0f * normal.x * normal.y;
+	m[2][0] = -2.0f * normal.x * normal.z;
+	m[3][0] = -2.0f * normal.x * d;
+
+	m[0][1] = -2.0f * normal.y * normal.x;
+	m[1][1] = 1.0f - 2.0f * normal.y * normal.y;
+	m[2][1] = -2.0f * normal.y * normal.z;
+	m[3][1] = -2.0f * normal.y * d;
+
+	m[0][2] = -2.0f * normal.z * normal.x;
+	m[1][2] = -2.0f * normal.z * normal.y;
+	m[2][2] = 1.0f - 2.0f * normal.z * normal.z;
+	m[3][2] = -2.0f * normal.z * d;
+	return m;
+}
+
+// Косая ближняя плоскость отсечения (E. Lengyel, "Oblique View Frustum Depth Projection and Clipping").
+// clipPlane задаётся в пространстве камеры; всё, что лежит позади неё, отсекается
+// самой проекцией, без gl_ClipDistance в шейдере.
+inline glm::mat4 obliqueProjection(glm::mat4 projection, const glm::vec4& clipPlane) {
+	glm::vec4 q;
+	q.x = (glm::sign(clipPlane.x) + projection[2][0]) / projection[0][0];
+	q.y = (glm::sign(clipPlane.y) + projection[2][1]) / projection[1][1];
+	q.z = -1.0f;
+	q.w = (1.0f + projection[2][2]) / projection[3][2];
+
+	glm::vec4 c = clipPlane * (2.0f / glm::dot(clipPlane, q));
+	projection[0][2] = c.x;
+	projection[1][2] = c.y;
+	projection[2][2] = c.z + 1.0f;
+	projection[3][2] = c.w;
+	return projection;
+}
+
+// Пирамида видимости «сквозь» прямоугольник зеркала: четыре боковые плоскости
+// проходят через отражённую камеру и рёбра зеркала, пятая — плоскость зеркала.
+// Шестая (дальняя) передаётся снаружи.
+inline void mirrorFrustumPlanes(const glm::vec3& reflectedEye, const glm::vec3 corners[4],
+	const glm::vec3& mirrorNormal, const glm::vec4& farPlane, glm::vec4 planes[6]) {
+	glm::vec3 center = (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f;
+	// Точка заведомо внутри пирамиды: за зеркалом на продолжении луча от камеры
+	glm::vec3 inside = center + (center - reflectedEye);
+
+	for (int i = 0; i < 4; ++i) {
+		const glm::vec3& a = corners[i];
+		const glm::vec3& b = corners[(i + 1) % 4];
+		glm::vec3 normal = glm::normalize(glm::cross(a - reflectedEye, b - reflectedEye));
+		float d = -glm::dot(normal, reflectedEye);
+		if (glm::dot(normal, inside) + d < 0.0f) {
+			normal = -normal;
+			d = -d;
+		}
+		planes[i] = glm::vec4(normal, d);
+	}
+
+	planes[4] = glm::vec4(mirrorNormal, -glm::dot(mirrorNormal, center));
+	planes[5] = farPlane;
+}
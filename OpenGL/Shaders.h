@@ -0,0 +1,447 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <iostream>
+#include <string>
+
+// Исходники шейдеров и их компиляция. Общие для приложения и бенчмарков,
+// поэтому бенчмарк компилирует ровно те шейдеры, что рисуют сцену.
+
+const char* const vertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;       // Позиция вершины
+layout (location = 1) in vec3 aNormal;    // Нормаль вершины
+layout (location = 2) in vec2 aTexCoord;  // Текстурные координаты
+layout (location = 3) in vec4 aInstance;  // Смещение (xyz) и масштаб (w) экземпляра
+uniform vec3 cursorWorldPos; 
+
+out vec3 FragPos;       // Позиция фрагмента в мировом пространстве
+out vec3 Normal;        // Нормаль фрагмента 
+out vec2 TexCoord;      // Текстурные координаты
+flat out vec4 Material; // Материал (см. fragmentShaderSource)
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool instanced;   // Матрица модели берётся из aInstance, а не из uniform
+uniform vec4 material;
+
+void main() {
+    mat4 modelMatrix = model;
+    if (instanced) {
+        modelMatrix = mat4(
+            vec4(aInstance.w, 0.0, 0.0, 0.0),
+            vec4(0.0, aInstance.w, 0.0, 0.0),
+            vec4(0.0, 0.0, aInstance.w, 0.0),
+            vec4(aInstance.xyz, 1.0));
+    }
+
+    FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(modelMatrix))) * aNormal;
+    TexCoord = aTexCoord;
+    Material = material;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+// Вершинный шейдер для glMultiDrawElementsIndirect: матрица модели и материал
+// берутся из SSBO по индексу записи (baseInstance + номер экземпляра)
+const char* const multiDrawVertexShaderSource = R"(
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 4) in uint aDrawIndex;
+
+struct DrawData {
+    mat4 model;
+    vec4 material;
+};
+
+layout (std430, binding = 0) readonly buffer DrawBuffer {
+    DrawData draws[];
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoord;
+flat out vec4 Material;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main() {
+    DrawData draw = draws[aDrawIndex];
+
+    FragPos = vec3(draw.model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(draw.model))) * aNormal;
+    TexCoord = aTexCoord;
+    Material = draw.material;
+
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+const char* const fragmentShaderSource = R"(
+#version 330 core
+
+struct Ray {
+    vec3 origin;
+    vec3 dir;
+};
+
+struct HitInfo {
+    float t;
+    vec3 normal;
+    bool hit;
+};
+
+HitInfo intersectFloor(Ray ray) {
+    HitInfo hit;
+    float t = (0.0 - ray.origin.y) / ray.dir.y;
+    if (t > 0.001) {
+        hit.t = t;
+        hit.normal = vec3(0, 1, 0);
+        hit.hit = true;
+    } else {
+        hit.hit = false;
+    }
+    return hit;
+}
+
+out vec4 FragColor;
+
+in vec3 FragPos;       // Позиция фрагмента
+in vec3 Normal;        // Нормаль фрагмента
+in vec2 TexCoord;      // Текстурные координаты
+flat in vec4 Material; // x — текстура стены вместо текстуры пола, y — лампа (без освещения)
+
+uniform vec3 lightPos;     // Позиция источника света
+uniform vec3 viewPos;      // Позиция камеры
+uniform vec3 lightColor;   // Цвет света
+uniform vec3 lightDir;     // Направление света
+uniform float cutOff;      // Внутренний угол отсечения
+uniform float outerCutOff; // Внешний угол отсечения 
+
+uniform sampler2D texture1;  // Основная текстура (пол)
+uniform sampler2D texture2;  // Текстура стены
+uniform samplerCube skybox;  // Карта отражений 
+uniform bool isMirror;
+uniform sampler2D reflectionTexture;      // Отражение сцены (рендер в текстуру)
+uniform mat4 reflectionViewProjection;    // Матрица, с которой отрендерено отражение
+uniform bool hasReflection;
+
+#define MAX_LAMPS 8
+uniform int lampCount;
+uniform vec3 lampPositions[MAX_LAMPS];
+uniform vec3 lampColors[MAX_LAMPS];
+
+// Карты теней в атласе: 0 — прожектор, 1.. — лампы
+uniform bool shadowsEnabled;
+uniform sampler2DShadow shadowAtlas;
+uniform mat4 shadowMatrices[MAX_LAMPS + 1];
+uniform vec4 shadowTiles[MAX_LAMPS + 1];   // Смещение (xy) и размер (zw) тайла в атласе
+
+// Доля света источника, дошедшая до фрагмента (1 — тени нет)
+float shadowFactor(int light, vec3 normal) {
+    if (!shadowsEnabled) return 1.0;
+    // Небольшой сдвиг по нормали против самозатенения
+    vec4 lightClip = shadowMatrices[light] * vec4(FragPos + normal * 0.02, 1.0);
+    if (lightClip.w <= 0.0) return 1.0;
+    vec3 coord = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+    // Вне пирамиды источника тень не считается
+    if (any(lessThan(coord, vec3(0.0))) || any(greaterThan(coord, vec3(1.0)))) return 1.0;
+
+    // Четыре выборки с аппаратным сравнением, не выходя за границы тайла
+    vec4 tile = shadowTiles[light];
+    vec2 texel = 1.0 / vec2(textureSize(shadowAtlas, 0));
+    vec2 uv = tile.xy + coord.xy * tile.zw;
+    vec2 minUV = tile.xy + texel;
+    vec2 maxUV = tile.xy + tile.zw - texel;
+    float lit = 0.0;
+    lit += texture(shadowAtlas, vec3(clamp(uv + vec2(-0.5, -0.5) * texel, minUV, maxUV), coord.z));
+    lit += texture(shadowAtlas, vec3(clamp(uv + vec2( 0.5, -0.5) * texel, minUV, maxUV), coord.z));
+    lit += texture(shadowAtlas, vec3(clamp(uv + vec2(-0.5,  0.5) * texel, minUV, maxUV), coord.z));
+    lit += texture(shadowAtlas, vec3(clamp(uv + vec2( 0.5,  0.5) * texel, minUV, maxUV), coord.z));
+    return lit * 0.25;
+}
+
+void main() {
+    if (Material.y > 0.5) {
+        FragColor = vec4(1.0);
+        return;
+    }
+
+	if (isMirror) {
+        if (hasReflection) {
+            // Проецируем точку зеркала той же матрицей, что и при рендере отражения,
+            // поэтому текстура, обновлённая несколько кадров назад, остаётся согласованной
+            vec4 reflectionClip = reflectionViewProjection * vec4(FragPos, 1.0);
+            vec2 reflectionUV = reflectionClip.xy / reflectionClip.w * 0.5 + 0.5;
+            FragColor = vec4(texture(reflectionTexture, reflectionUV).rgb * 0.95, 1.0);
+            return;
+        }
+
+        Ray ray;
+        ray.origin = FragPos + 0.001 * Normal;
+        ray.dir = reflect(normalize(FragPos - viewPos), normalize(Normal));
+        HitInfo hit = intersectFloor(ray);
+        if (hit.hit) {
+            vec3 hitPoint = ray.origin + ray.dir * hit.t;
+            vec3 lightDirNorm = normalize(lightPos - hitPoint);
+            float diff = max(dot(hit.normal, lightDirNorm), 0.0);
+            vec3 color = vec3(0.7, 0.7, 0.7) * diff + 0.1;
+            FragColor = vec4(color, 1.0);
+        } else {
+            FragColor = vec4(0.3, 0.5, 0.8, 1.0);
+        }
+        return;
+    }
+    
+
+    // Освещение по Фонгу (основной прожектор)
+    vec3 norm = normalize(Normal);
+    vec3 lightDirection = normalize(lightPos - FragPos);
+
+    // Диффузное освещение
+    float diff = max(dot(norm, lightDirection), 0.0);
+
+    // Зеркальное освещение
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-lightDirection, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+
+    // Прожектор
+    float theta = dot(normalize(lightDirection), normalize(-lightDir));
+    float epsilon = cutOff - outerCutOff;
+    float intensity = clamp((theta - outerCutOff) / epsilon, 0.0, 1.0);
+
+    float spotShadow = shadowFactor(0, norm);
+    vec3 ambient = 0.1 * lightColor;
+    vec3 diffuse = diff * lightColor * intensity * spotShadow;
+    vec3 specular = spec * lightColor * intensity * spotShadow;
+
+    //Освещение от настенных ламп
+    vec3 lampDiffuse = vec3(0.0);
+    vec3 lampSpecular = vec3(0.0);
+    
+    for(int i = 0; i < lampCount; i++) {
+        vec3 lampDir = normalize(lampPositions[i] - FragPos);
+        float distance = length(lampPositions[i] - FragPos);
+		float attenuation = 1.0 / (1.0 + 0.1 * distance + 0.05 * (distance * distance));
+        attenuation *= shadowFactor(i + 1, norm);
+        
+        float lampDiff = max(dot(norm, lampDir), 0.0);
+        lampDiffuse += lampDiff * lampColors[i] * attenuation * 1.0;
+        
+        vec3 lampReflectDir = reflect(-lampDir, norm);
+        float lampSpec = pow(max(dot(viewDir, lampReflectDir), 0.0), 32);
+        lampSpecular += lampSpec * lampColors[i] * attenuation * 0.5;
+    }
+
+    vec3 phong = ambient + (diffuse + specular) * intensity + lampDiffuse + lampSpecular;
+
+    // Карта отражений
+    vec3 I = normalize(FragPos - viewPos);
+    vec3 reflection = texture(skybox, reflect(I, norm)).rgb;
+
+    // Итоговый цвет
+    vec3 textureColor = Material.x > 0.5 ? texture(texture2, TexCoord).rgb : texture(texture1, TexCoord).rgb;
+    vec3 finalColor = mix(phong * textureColor, reflection * 1.5, 0.1);
+
+    FragColor = vec4(finalColor, 1.0);
+
+}
+)";
+
+// Отсечение мусора на GPU (см. GpuDebris.h): видимые экземпляры сжимаются в
+// буфер visible, их число накапливается в instanceCount команды отрисовки
+const char* const debrisCullComputeShaderSource = R"(
+#version 430 core
+layout (local_size_x = 256) in;
+
+layout (std430, binding = 1) readonly buffer DebrisBuffer {
+    vec4 debris[];              // Позиция (xyz) и масштаб (w, 0 — подобран)
+};
+layout (std430, binding = 2) writeonly buffer VisibleBuffer {
+    vec4 visible[];
+};
+layout (std430, binding = 3) buffer CommandBuffer {
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+uniform vec4 planes[6];
+uniform uint debrisCount;
+
+void main() {
+    uint id = gl_GlobalInvocationID.x;
+    if (id >= debrisCount) return;
+
+    vec4 object = debris[id];
+    if (object.w == 0.0) return;
+
+    // Описанная сфера куба с ребром object.w
+    float radius = object.w * 0.8660254;
+    for (int i = 0; i < 6; ++i) {
+        if (dot(planes[i].xyz, object.xyz) + planes[i].w < -radius) return;
+    }
+    visible[atomicAdd(instanceCount, 1u)] = object;
+}
+)";
+
+// Проход теней: только глубина из точки зрения источника. Формат вершин и
+// данные экземпляров те же, что у основного шейдера, поэтому рендер объектов
+// переиспользуется как есть (projection — матрица источника, view — единичная).
+const char* const shadowVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in vec4 aInstance;  // Смещение (xyz) и масштаб (w) экземпляра
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool instanced;
+
+void main() {
+    vec4 worldPos = instanced ? vec4(aPos * aInstance.w + aInstance.xyz, 1.0) : model * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPos;
+}
+)";
+
+const char* const shadowFragmentShaderSource = R"(
+#version 330 core
+void main() {
+}
+)";
+
+const char* const uiVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+out vec3 Color;
+
+uniform mat4 projection;
+uniform mat4 model;
+
+void main() {
+    Color = aColor;
+    gl_Position = projection * model * vec4(aPos, 1.0);
+}
+)";
+
+const char* const uiFragmentShaderSource = R"(
+#version 330 core
+in vec3 Color;
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(Color, 0.5);
+}
+)";
+
+// Проверка ошибок компиляции шейдеров
+inline void checkShaderCompilation(unsigned int shader, const std::string& type) {
+	int success;
+	char infoLog[1024];
+	if (type == "PROGRAM") {
+		glGetProgramiv(shader, GL_LINK_STATUS, &success);
+		if (!success) {
+			glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+			std::cerr << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n";
+		}
+	}
+	else {
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+			std::cerr << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n";
+		}
+	}
+}
+
+// Компиляция и линковка программы; возвращает 0, если линковка не удалась
+inline unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertexShader, 1, &vertexSource, nullptr);
+	glCompileShader(vertexShader);
+	checkShaderCompilation(vertexShader, "VERTEX");
+
+	unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragmentShader, 1, &fragmentSource, nullptr);
+	glCompileShader(fragmentShader);
+	checkShaderCompilation(fragmentShader, "FRAGMENT");
+
+	unsigned int program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	glLinkProgram(program);
+	checkShaderCompilation(program, "PROGRAM");
+
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+// Компиляция compute-шейдера (GL 4.3); возвращает 0, если он недоступен или не собрался
+inline unsigned int createComputeProgram(const char* computeSource) {
+#ifdef GL_COMPUTE_SHADER
+	unsigned int computeShader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(computeShader, 1, &computeSource, nullptr);
+	glCompileShader(computeShader);
+	checkShaderCompilation(computeShader, "COMPUTE");
+
+	unsigned int program = glCreateProgram();
+	glAttachShader(program, computeShader);
+	glLinkProgram(program);
+	checkShaderCompilation(program, "PROGRAM");
+	glDeleteShader(computeShader);
+
+	int success = 0;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+#else
+	(void)computeSource;
+	return 0;
+#endif
+}
+
+// Текстурные блоки шейдера сцены: 0 — пол, 1 — карта отражений, 2 — отражение
+// зеркала, 3 — стена, 4 — атлас теней. Сэмплеры разных типов не могут делить
+// один блок, иначе каждая отрисовка завершается GL_INVALID_OPERATION.
+// Текстуры привязываются один раз при загрузке, материалы выбирают нужную в шейдере.
+inline void setupSamplerUniforms(unsigned int shaderProgram) {
+	glUseProgram(shaderProgram);
+	glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+	glUniform1i(glGetUniformLocation(shaderProgram, "skybox"), 1);
+	glUniform1i(glGetUniformLocation(shaderProgram, "reflectionTexture"), 2);
+	glUniform1i(glGetUniformLocation(shaderProgram, "texture2"), 3);
+	glUniform1i(glGetUniformLocation(shaderProgram, "shadowAtlas"), 4);
+}
+
+// Тот же шейдер с другой строкой #version (первая непустая строка исходника)
+inline std::string replaceShaderVersion(const char* source, const char* version) {
+	std::string result(source);
+	size_t start = result.find("#version");
+	if (start != std::string::npos) {
+		size_t end = result.find('\n', start);
+		result.replace(start, end - start, version);
+	}
+	return result;
+}
@@ -0,0 +1,156 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <iostream>
+#include "GpuTimer.h"
+
+// Атлас карт теней: одна текстура глубины, разбитая на квадратные тайлы, по
+// тайлу на источник света. Рядом лежит второй атлас того же размера — кэш, в
+// который статическая геометрия (пол, стена) рендерится один раз. Обновление
+// тайла неподвижного источника — копия глубины из кэша (glBlitFramebuffer) и
+// рендер поверх неё только подвижных объектов.
+struct ShadowAtlas {
+	unsigned int fbo = 0;
+	unsigned int depthTexture = 0;         // Читается шейдером сцены (sampler2DShadow)
+	unsigned int staticFbo = 0;
+	unsigned int staticDepthTexture = 0;   // Только статическая геометрия
+	int tileSize = 0;
+	int tilesPerRow = 0;
+	int tileCount = 0;
+	int size = 0;                          // Сторона атласа в пикселях
+
+	bool useStaticCache = true;
+
+	// Замеры времени прохода теней; метка замера — номер фазы сравнения
+	GpuTimer timer;
+	double gpuTimeMs[2] = {};
+	int timedPasses[2] = {};
+
+	int tileUpdates = 0;                   // Перерисованные тайлы
+	int tilesSkipped = 0;                  // Тайлы, оставленные с прошлого кадра
+	int staticTileRenders = 0;             // Рендеры статической геометрии
+};
+
+// Источник с картой теней в атласе
+struct ShadowLight {
+	int tile = 0;
+	bool moving = false;                   // Движется (прожектор робота): статический кэш неприменим
+	glm::vec3 position{ 0.0f };
+	glm::mat4 viewProjection{ 1.0f };
+	glm::vec4 planes[6];                   // Пирамида источника для отсечения теней
+	bool staticCached = false;             // Статическая геометрия уже в кэше
+	bool dirty = true;                     // Тайл нужно перерисовать
+	bool casterInside = false;             // Робот был в пирамиде при последней перерисовке
+};
+
+inline unsigned int createShadowDepthTexture(int size, bool compare) {
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, compare ? GL_LINEAR : GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	if (compare) {
+		// Аппаратное сравнение с билинейной фильтрацией (PCF 2x2)
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	}
+	return texture;
+}
+
+inline unsigned int createShadowFramebuffer(unsigned int depthTexture) {
+	unsigned int fbo;
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "Shadow framebuffer is incomplete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return fbo;
+}
+
+inline void createShadowAtlas(ShadowAtlas& atlas, int tileSize, int tileCount) {
+	atlas.tileSize = tileSize;
+	atlas.tileCount = tileCount;
+	atlas.tilesPerRow = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(tileCount))));
+	atlas.size = tileSize * atlas.tilesPerRow;
+
+	atlas.depthTexture = createShadowDepthTexture(atlas.size, true);
+	atlas.fbo = createShadowFramebuffer(atlas.depthTexture);
+	atlas.staticDepthTexture = createShadowDepthTexture(atlas.size, false);
+	atlas.staticFbo = createShadowFramebuffer(atlas.staticDepthTexture);
+
+	createGpuTimer(atlas.timer);
+}
+
+inline void deleteShadowAtlas(ShadowAtlas& atlas) {
+	deleteGpuTimer(atlas.timer);
+	glDeleteFramebuffers(1, &atlas.fbo);
+	glDeleteFramebuffers(1, &atlas.staticFbo);
+	glDeleteTextures(1, &atlas.depthTexture);
+	glDeleteTextures(1, &atlas.staticDepthTexture);
+	atlas = ShadowAtlas();
+}
+
+inline void shadowTileOrigin(const ShadowAtlas& atlas, int tile, int& x, int& y) {
+	x = (tile % atlas.tilesPerRow) * atlas.tileSize;
+	y = (tile / atlas.tilesPerRow) * atlas.tileSize;
+}
+
+// Смещение (xy) и размер (zw) тайла в текстурных координатах атласа
+inline glm::vec4 shadowTileRect(const ShadowAtlas& atlas, int tile) {
+	int x, y;
+	shadowTileOrigin(atlas, tile, x, y);
+	float inverseSize = 1.0f / static_cast<float>(atlas.size);
+	return glm::vec4(x * inverseSize, y * inverseSize, atlas.tileSize * inverseSize, atlas.tileSize * inverseSize);
+}
+
+// Рендер в тайл: viewport и scissor ограничены тайлом, поэтому glClear и
+// glBlitFramebuffer не задевают соседей
+inline void bindShadowTile(const ShadowAtlas& atlas, unsigned int fbo, int tile) {
+	int x, y;
+	shadowTileOrigin(atlas, tile, x, y);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(x, y, atlas.tileSize, atlas.tileSize);
+	glScissor(x, y, atlas.tileSize, atlas.tileSize);
+}
+
+// Начало перерисовки тайла: глубина статической геометрии из кэша или пустой тайл
+inline void beginShadowTile(const ShadowAtlas& atlas, int tile, bool fromStaticCache) {
+	bindShadowTile(atlas, atlas.fbo, tile);
+	if (!fromStaticCache) {
+		glClear(GL_DEPTH_BUFFER_BIT);
+		return;
+	}
+
+	int x, y;
+	shadowTileOrigin(atlas, tile, x, y);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, atlas.staticFbo);
+	glBlitFramebuffer(x, y, x + atlas.tileSize, y + atlas.tileSize, x, y, x + atlas.tileSize, y + atlas.tileSize,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, atlas.fbo);
+}
+
+// Прожектор или лампа как перспективная проекция из position вдоль direction
+inline glm::mat4 spotShadowMatrix(const glm::vec3& position, const glm::vec3& direction, float fovDegrees,
+	float nearPlane, float farPlane) {
+	glm::vec3 up = std::fabs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::mat4 view = glm::lookAt(position, position + direction, up);
+	return glm::perspective(glm::radians(fovDegrees), 1.0f, nearPlane, farPlane) * view;
+}
+
+// Забирает завершённые замеры без ожидания GPU
+inline void collectShadowTiming(ShadowAtlas& atlas) {
+	collectGpuTimer(atlas.timer, [&](double ms, int phase) {
+		atlas.gpuTimeMs[phase] += ms;
+		atlas.timedPasses[phase]++;
+	});
+}
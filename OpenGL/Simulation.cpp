@@ -0,0 +1,169 @@
+﻿#include "Simulation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+LevelFile level;
+
+std::vector<glm::vec3> objects;
+std::vector<uint32_t> objectIds;
+std::vector<uint32_t> removedDebris;
+int score = 0;
+
+float batteryLife = 100.0f;
+
+// Позиция робота-пылесоса
+glm::vec3 robotPosition(0.0f, 0.5f, 0.0f);
+glm::vec3 robotDirection(0.0f, 0.0f, -1.0f);
+
+unsigned int spawnSeed = 0;
+
+bool coverageCells[coverageGridSize][coverageGridSize] = {};
+int coveredCells = 0;
+
+void updateCoverage() {
+	int cellX = glm::clamp(static_cast<int>(robotPosition.x + coverageGridSize * 0.5f), 0, coverageGridSize - 1);
+	int cellZ = glm::clamp(static_cast<int>(robotPosition.z + coverageGridSize * 0.5f), 0, coverageGridSize - 1);
+	if (!coverageCells[cellX][cellZ]) {
+		coverageCells[cellX][cellZ] = true;
+		coveredCells++;
+	}
+}
+
+void resetCoverage() {
+	std::memset(coverageCells, 0, sizeof(coverageCells));
+	coveredCells = 0;
+}
+
+bool blockedByObstacle(const glm::vec3& position, float radius) {
+	for (const LevelObstacle& obstacle : level.obstacles) {
+		if (position.x + radius > obstacle.min[0] && position.x - radius < obstacle.max[0] &&
+			position.y + radius > obstacle.min[1] && position.y - radius < obstacle.max[1] &&
+			position.z + radius > obstacle.min[2] && position.z - radius < obstacle.max[2]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+float randomSpawnCoordinate(float min, float max, float gridStep) {
+	if (gridStep > 0.0f) {
+		int cells = static_cast<int>((max - min) / gridStep) + 1;
+		return min + gridStep * static_cast<float>(rand() % cells);
+	}
+	return min + (max - min) * static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
+}
+
+glm::vec3 randomSpawnPosition(const LevelDebrisSpawn& spawn) {
+	// Несколько попыток не попасть в препятствие, иначе мусор не собрать
+	glm::vec3 position;
+	for (int attempt = 0; attempt < 16; ++attempt) {
+		position = glm::vec3(randomSpawnCoordinate(spawn.min[0], spawn.max[0], spawn.gridStep),
+			randomSpawnCoordinate(spawn.min[1], spawn.max[1], spawn.gridStep),
+			randomSpawnCoordinate(spawn.min[2], spawn.max[2], spawn.gridStep));
+		if (!blockedByObstacle(position, 0.0f)) break;
+	}
+	return position;
+}
+
+// Фиксированные позиции копируются одним блоком, затем области появления дают
+// по spawn.count штук. При count >= 0 столько штук распределяется по областям
+// пропорционально их count.
+void spawnObjects(int count) {
+	srand(spawnSeed != 0 ? spawnSeed : static_cast<unsigned int>(time(0)));
+	static_assert(sizeof(LevelDebris) == sizeof(glm::vec3), "LevelDebris is copied as glm::vec3");
+	const glm::vec3* fixedDebris = reinterpret_cast<const glm::vec3*>(level.debris.data);
+
+	if (count < 0) {
+		objects.reserve(levelDebrisCount(level));
+		objects.assign(fixedDebris, fixedDebris + level.debris.size());
+		for (const LevelDebrisSpawn& spawn : level.debrisSpawns) {
+			for (uint32_t i = 0; i < spawn.count; ++i) {
+				objects.push_back(randomSpawnPosition(spawn));
+			}
+		}
+		return;
+	}
+
+	objects.reserve(count);
+	if (level.debrisSpawns.empty()) {
+		size_t fixedCount = std::min(level.debris.size(), static_cast<size_t>(count));
+		objects.assign(fixedDebris, fixedDebris + fixedCount);
+		return;
+	}
+
+	size_t totalWeight = 0;
+	for (const LevelDebrisSpawn& spawn : level.debrisSpawns) {
+		totalWeight += std::max<uint32_t>(spawn.count, 1);
+	}
+	size_t remaining = static_cast<size_t>(count);
+	for (size_t s = 0; s < level.debrisSpawns.size(); ++s) {
+		const LevelDebrisSpawn& spawn = level.debrisSpawns[s];
+		size_t spawnCount = s + 1 == level.debrisSpawns.size() ? remaining :
+			std::min(remaining, static_cast<size_t>(count) * std::max<uint32_t>(spawn.count, 1) / totalWeight);
+		for (size_t i = 0; i < spawnCount; ++i) {
+			objects.push_back(randomSpawnPosition(spawn));
+		}
+		remaining -= spawnCount;
+	}
+}
+
+void generateObjects(int count) {
+	spawnObjects(count);
+	objectIds.resize(objects.size());
+	for (size_t i = 0; i < objectIds.size(); ++i) {
+		objectIds[i] = static_cast<uint32_t>(i);
+	}
+	removedDebris.clear();
+}
+
+void checkCollisions() {
+	// Порядок мусора не важен, поэтому подобранный заменяется последним
+	for (size_t i = 0; i < objects.size();) {
+		if (glm::distance(robotPosition, objects[i]) < pickupRadius) {
+			removedDebris.push_back(objectIds[i]);
+			objects[i] = objects.back();
+			objects.pop_back();
+			objectIds[i] = objectIds.back();
+			objectIds.pop_back();
+			score++;
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+void resetEpisode(int debrisCount) {
+	batteryLife = 100.0f;
+	score = 0;
+	resetCoverage();
+	objects.clear();
+	generateObjects(debrisCount);
+}
+
+EpisodeState stepSimulation() {
+	glm::vec3 newPosition = robotPosition + robotDirection * robotSpeed;
+
+	if (newPosition.x > -9.5f && newPosition.x < 9.5f && newPosition.z > -9.5f && newPosition.z < 9.5f &&
+		!blockedByObstacle(newPosition, robotRadius)) {
+		robotPosition = newPosition;
+	}
+
+	checkCollisions();
+	updateCoverage();
+
+	// Уменьшение заряда батареи
+	batteryLife -= batteryDrainPerTick;
+
+	// Проверка завершения эпизода
+	if (objects.empty()) {
+		return EpisodeState::AllCollected;
+	}
+	if (batteryLife <= 0.0f) {
+		return EpisodeState::BatteryDepleted;
+	}
+	return EpisodeState::Running;
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "LevelFormat.h"
+
+// Симуляция без OpenGL: уровень, мусор, робот, батарея и покрытие пола.
+// Собирается отдельной библиотекой (vacuum_sim), которую используют и
+// интерактивное приложение, и бенчмарки. Приложение добавляет к шагу
+// симуляции ввод, отрисовку, буфер мусора на GPU и телеметрию.
+
+// Геометрия, лампы, препятствия и мусор загружаются из файла уровня (см. LevelFormat.h)
+extern LevelFile level;
+
+// Объекты для уборки. objectIds[i] — постоянный id объекта objects[i] в буфере GPU,
+// removedDebris — id, подобранные с момента последней очистки списка
+extern std::vector<glm::vec3> objects;
+extern std::vector<uint32_t> objectIds;
+extern std::vector<uint32_t> removedDebris;
+extern int score;
+
+// Таймер
+extern float batteryLife; // Заряд батареи (в процентах)
+const float batteryDrainPerTick = 0.05f;
+
+// Робот-пылесос
+extern glm::vec3 robotPosition;
+extern glm::vec3 robotDirection;
+const float robotSpeed = 0.05f;
+const float robotRadius = 0.5f;
+
+// Размер мусора относительно единичного куба
+const float debrisScale = 0.7f;
+
+// Радиус, в котором робот подбирает мусор
+const float pickupRadius = 0.6f;
+
+// Зерно расстановки мусора (0 — от текущего времени). С фиксированным зерном
+// каждый эпизод начинается с одной и той же расстановки.
+extern unsigned int spawnSeed;
+
+// Покрытие пола: клетки 1x1, по которым проехал робот
+const int coverageGridSize = 20;
+extern int coveredCells;
+
+// Итог шага симуляции
+enum class EpisodeState {
+	Running,
+	BatteryDepleted, // Пылесос разрядился
+	AllCollected     // Весь мусор собран
+};
+
+void updateCoverage();
+void resetCoverage();
+
+// Робот заданного радиуса не может заехать в препятствие уровня
+bool blockedByObstacle(const glm::vec3& position, float radius);
+
+// Расстановка мусора. count < 0 — как задано в уровне
+void spawnObjects(int count);
+
+// Генерация объектов нового эпизода; id мусора — его исходный индекс
+void generateObjects(int count);
+
+// Проверка столкновений; id подобранного мусора добавляются в removedDebris
+void checkCollisions();
+
+// Новый эпизод: полная батарея, нулевой счёт, новая расстановка мусора.
+// Робот остаётся там, где был, как и при перезапуске по R.
+void resetEpisode(int debrisCount);
+
+// Один шаг симуляции: движение вперёд, сбор мусора, покрытие и расход батареи
+EpisodeState stepSimulation();
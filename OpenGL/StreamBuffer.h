@@ -0,0 +1,138 @@
+﻿#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Кольцевой буфер для данных, которые меняются каждый кадр (данные экземпляров,
+// геометрия UI, отладочные линии). Буфер разбит на frameCount областей; кадр
+// пишет только в свою область, а перед повторным использованием области ждёт
+// её fence, поставленный glFenceSync в конце того кадра. Так драйверу не нужно
+// неявно синхронизироваться с GPU.
+//
+// Если доступен glBufferStorage (GL 4.4 / ARB_buffer_storage), буфер отображается
+// в память один раз (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) и данные
+// пишутся напрямую. На GL 3.3 данные пишутся в заранее выделенную копию в ОЗУ
+// и отправляются glBufferSubData в момент streamCommit.
+struct StreamBuffer {
+	static const int frameCount = 3;
+
+	unsigned int buffer = 0;
+	size_t frameSize = 0;
+	bool persistent = false;
+	unsigned char* memory = nullptr; // Отображённый буфер или копия в ОЗУ
+
+	int frameIndex = 0;
+	size_t frameOffset = 0;          // Занято в текущей области
+	GLsync fences[frameCount] = {};
+
+	int fenceWaits = 0;              // Сколько раз пришлось ждать GPU
+	bool overflowReported = false;
+};
+
+struct StreamAllocation {
+	void* data = nullptr;            // Куда писать на стороне CPU
+	size_t offset = 0;               // Смещение в буфере (для glVertexAttribPointer и т.п.)
+	size_t size = 0;
+};
+
+inline void createStreamBuffer(StreamBuffer& stream, size_t frameSize) {
+	stream.frameSize = frameSize;
+	size_t totalSize = frameSize * StreamBuffer::frameCount;
+
+	glGenBuffers(1, &stream.buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+
+#ifdef GL_MAP_PERSISTENT_BIT
+	if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+		stream.memory = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags));
+		stream.persistent = stream.memory != nullptr;
+		if (!stream.persistent) {
+			// glBufferStorage делает буфер неизменяемым, поэтому для запасного пути нужен новый
+			glDeleteBuffers(1, &stream.buffer);
+			glGenBuffers(1, &stream.buffer);
+			glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+		}
+	}
+#endif
+
+	if (!stream.persistent) {
+		glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+		stream.memory = static_cast<unsigned char*>(std::malloc(totalSize));
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+inline void deleteStreamBuffer(StreamBuffer& stream) {
+	for (int i = 0; i < StreamBuffer::frameCount; ++i) {
+		if (stream.fences[i]) glDeleteSync(stream.fences[i]);
+	}
+	if (stream.persistent) {
+		glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else {
+		std::free(stream.memory);
+	}
+	glDeleteBuffers(1, &stream.buffer);
+	stream = StreamBuffer();
+}
+
+// Начало кадра: ждём, пока GPU закончит читать область, в которую будем писать
+inline void beginStreamFrame(StreamBuffer& stream) {
+	GLsync& fence = stream.fences[stream.frameIndex];
+	if (fence) {
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			stream.fenceWaits++;
+			do {
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			} while (result == GL_TIMEOUT_EXPIRED);
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+	stream.frameOffset = 0;
+}
+
+// Конец кадра: отмечаем, что область занята до завершения команд этого кадра
+inline void endStreamFrame(StreamBuffer& stream) {
+	stream.fences[stream.frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	stream.frameIndex = (stream.frameIndex + 1) % StreamBuffer::frameCount;
+}
+
+// Выделение в текущей области. alignment может быть не степенью двойки
+// (например, шаг вершины), выравнивается смещение от начала буфера.
+inline StreamAllocation streamAllocate(StreamBuffer& stream, size_t bytes, size_t alignment = 16) {
+	StreamAllocation allocation;
+	size_t frameStart = stream.frameSize * stream.frameIndex;
+	size_t offset = frameStart + stream.frameOffset;
+	offset = (offset + alignment - 1) / alignment * alignment;
+
+	if (offset + bytes > frameStart + stream.frameSize) {
+		if (!stream.overflowReported) {
+			std::cerr << "StreamBuffer overflow: requested " << bytes << " bytes, frame size " << stream.frameSize << std::endl;
+			stream.overflowReported = true;
+		}
+		return allocation;
+	}
+
+	stream.frameOffset = offset + bytes - frameStart;
+	allocation.data = stream.memory + offset;
+	allocation.offset = offset;
+	allocation.size = bytes;
+	return allocation;
+}
+
+// Делает записанные данные видимыми GPU (для отображённого буфера ничего не нужно)
+inline void streamCommit(StreamBuffer& stream, const StreamAllocation& allocation, size_t bytes) {
+	if (stream.persistent || bytes == 0) return;
+	glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, allocation.offset, bytes, allocation.data);
+}
@@ -0,0 +1,262 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // windows.h не должен переопределять std::min/std::max
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+typedef SOCKET TelemetrySocket;
+#define TELEMETRY_INVALID_SOCKET INVALID_SOCKET
+#define telemetryCloseSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+typedef int TelemetrySocket;
+#define TELEMETRY_INVALID_SOCKET (-1)
+#define telemetryCloseSocket close
+#endif
+
+// Метрики симуляции и рендера. Цикл рендера только обновляет атомарные
+// значения (relaxed, без блокировок), а фоновый поток MetricsServer читает их
+// и отдаёт в текстовом формате Prometheus. Медленный клиент задерживает только
+// фоновый поток.
+
+// Гистограмма с фиксированными границами корзин. Отдельного счётчика
+// наблюдений нет: _count — сумма корзин, поэтому он всегда равен корзине +Inf,
+// даже если чтение пришлось на середину observe()
+struct AtomicHistogram {
+	static const int bucketCount = 8;
+	const double bounds[bucketCount] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 66.7, 1.0e30 }; // Последняя — +Inf
+
+	std::atomic<uint64_t> buckets[bucketCount] = {};
+	std::atomic<uint64_t> sumMicros{ 0 };
+
+	void observe(double valueMs) {
+		for (int i = 0; i < bucketCount; ++i) {
+			if (valueMs <= bounds[i]) {
+				buckets[i].fetch_add(1, std::memory_order_relaxed);
+				break;
+			}
+		}
+		sumMicros.fetch_add(static_cast<uint64_t>(valueMs * 1000.0), std::memory_order_relaxed);
+	}
+};
+
+struct Telemetry {
+	std::atomic<uint64_t> framesTotal{ 0 };
+	std::atomic<uint64_t> ticksTotal{ 0 };        // Шаги симуляции
+	std::atomic<uint64_t> drawCallsTotal{ 0 };
+	std::atomic<uint64_t> pickupsTotal{ 0 };
+	std::atomic<uint64_t> episodesTotal{ 0 };
+
+	std::atomic<uint32_t> frameDrawCalls{ 0 };    // За последний кадр
+	std::atomic<uint32_t> debrisRemaining{ 0 };
+	std::atomic<float> ticksPerSecond{ 0.0f };
+	std::atomic<float> batteryLevel{ 0.0f };      // Проценты
+	std::atomic<float> coverage{ 0.0f };          // Доля убранной площади пола, 0..1
+
+	AtomicHistogram frameTimeMs;
+};
+
+// Дописывает текст в буфер метрик. При нехватке места текст обрезается, и
+// length остаётся на завершающем нуле (он не входит в ответ)
+#if defined(__GNUC__)
+__attribute__((format(printf, 4, 5)))
+#endif
+inline void appendMetricsText(char* buffer, size_t capacity, size_t& length, const char* format, ...) {
+	if (length + 1 >= capacity) return;
+	va_list args;
+	va_start(args, format);
+	int written = std::vsnprintf(buffer + length, capacity - length, format, args);
+	va_end(args);
+	if (written > 0) length += static_cast<size_t>(written);
+	if (length > capacity - 1) length = capacity - 1;
+}
+
+// Текст в формате Prometheus в заранее выделенный буфер (без выделений памяти)
+inline size_t formatPrometheusMetrics(const Telemetry& telemetry, char* buffer, size_t capacity) {
+	size_t length = 0;
+	auto counter = [&](const char* name, const char* help, unsigned long long value) {
+		appendMetricsText(buffer, capacity, length, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name, value);
+	};
+	auto gauge = [&](const char* name, const char* help, double value) {
+		appendMetricsText(buffer, capacity, length, "# HELP %s %s\n# TYPE %s gauge\n%s %g\n", name, help, name, name, value);
+	};
+	const std::memory_order relaxed = std::memory_order_relaxed;
+
+	counter("vacuum_frames_total", "Rendered frames.", telemetry.framesTotal.load(relaxed));
+	counter("vacuum_sim_ticks_total", "Simulation ticks.", telemetry.ticksTotal.load(relaxed));
+	counter("vacuum_draw_calls_total", "Draw calls issued.", telemetry.drawCallsTotal.load(relaxed));
+	counter("vacuum_pickups_total", "Debris picked up.", telemetry.pickupsTotal.load(relaxed));
+	counter("vacuum_episodes_total", "Finished episodes.", telemetry.episodesTotal.load(relaxed));
+
+	gauge("vacuum_sim_ticks_per_second", "Simulation ticks during the last second.", telemetry.ticksPerSecond.load(relaxed));
+	gauge("vacuum_frame_draw_calls", "Draw calls in the last frame.", telemetry.frameDrawCalls.load(relaxed));
+	gauge("vacuum_debris_remaining", "Debris left on the floor.", telemetry.debrisRemaining.load(relaxed));
+	gauge("vacuum_battery_percent", "Battery level.", telemetry.batteryLevel.load(relaxed));
+	gauge("vacuum_coverage_ratio", "Fraction of the floor the robot has passed over.", telemetry.coverage.load(relaxed));
+
+	const AtomicHistogram& histogram = telemetry.frameTimeMs;
+	appendMetricsText(buffer, capacity, length, "%s", "# HELP vacuum_frame_time_ms Frame time.\n# TYPE vacuum_frame_time_ms histogram\n");
+	unsigned long long cumulative = 0;
+	for (int i = 0; i < AtomicHistogram::bucketCount; ++i) {
+		cumulative += histogram.buckets[i].load(relaxed);
+		if (i + 1 < AtomicHistogram::bucketCount) {
+			appendMetricsText(buffer, capacity, length, "vacuum_frame_time_ms_bucket{le=\"%g\"} %llu\n", histogram.bounds[i], cumulative);
+		}
+		else {
+			appendMetricsText(buffer, capacity, length, "vacuum_frame_time_ms_bucket{le=\"+Inf\"} %llu\n", cumulative);
+		}
+	}
+	appendMetricsText(buffer, capacity, length, "vacuum_frame_time_ms_sum %g\n", histogram.sumMicros.load(relaxed) / 1000.0);
+	appendMetricsText(buffer, capacity, length, "vacuum_frame_time_ms_count %llu\n", cumulative);
+	return length;
+}
+
+// HTTP-сервер метрик на 127.0.0.1 в фоновом потоке. Отвечает на любой запрос
+// содержимым /metrics и закрывает соединение.
+class MetricsServer {
+public:
+	explicit MetricsServer(const Telemetry& telemetry) : telemetry(telemetry) {
+	}
+
+	~MetricsServer() {
+		stop();
+	}
+
+	MetricsServer(const MetricsServer&) = delete;
+	MetricsServer& operator=(const MetricsServer&) = delete;
+
+	bool start(int port) {
+#ifdef _WIN32
+		WSADATA wsaData;
+		if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+			std::cerr << "Metrics server: WSAStartup failed" << std::endl;
+			return false;
+		}
+		wsaStarted = true;
+#endif
+		listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (listener == TELEMETRY_INVALID_SOCKET) {
+			std::cerr << "Metrics server: cannot create socket" << std::endl;
+			return false;
+		}
+
+		int reuse = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+		sockaddr_in address;
+		std::memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(static_cast<unsigned short>(port));
+
+		if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 4) != 0) {
+			std::cerr << "Metrics server: cannot listen on 127.0.0.1:" << port << std::endl;
+			telemetryCloseSocket(listener);
+			listener = TELEMETRY_INVALID_SOCKET;
+			return false;
+		}
+
+		running.store(true);
+		worker = std::thread(&MetricsServer::serve, this);
+		std::cout << "Metrics: http://127.0.0.1:" << port << "/metrics" << std::endl;
+		return true;
+	}
+
+	void stop() {
+		if (running.exchange(false) && worker.joinable()) {
+			worker.join();
+		}
+		if (listener != TELEMETRY_INVALID_SOCKET) {
+			telemetryCloseSocket(listener);
+			listener = TELEMETRY_INVALID_SOCKET;
+		}
+#ifdef _WIN32
+		if (wsaStarted) {
+			WSACleanup();
+			wsaStarted = false;
+		}
+#endif
+	}
+
+private:
+	void serve() {
+		while (running.load()) {
+			// Ждём клиента с таймаутом, чтобы вовремя заметить stop()
+			fd_set readSet;
+			FD_ZERO(&readSet);
+			FD_SET(listener, &readSet);
+			timeval timeout;
+			timeout.tv_sec = 0;
+			timeout.tv_usec = 200000;
+			if (select(static_cast<int>(listener) + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+				continue;
+			}
+
+			TelemetrySocket client = accept(listener, nullptr, nullptr);
+			if (client == TELEMETRY_INVALID_SOCKET) continue;
+
+			// Медленный клиент не должен держать поток бесконечно
+#ifdef _WIN32
+			DWORD ioTimeout = 1000;
+#else
+			timeval ioTimeout;
+			ioTimeout.tv_sec = 1;
+			ioTimeout.tv_usec = 0;
+#endif
+			setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&ioTimeout), sizeof(ioTimeout));
+			setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&ioTimeout), sizeof(ioTimeout));
+
+			// Содержимое запроса не важно, читаем только чтобы не сбросить соединение раньше времени
+			recv(client, request, sizeof(request), 0);
+
+			size_t bodyLength = formatPrometheusMetrics(telemetry, body, sizeof(body));
+			int headerLength = std::snprintf(header, sizeof(header),
+				"HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+				bodyLength);
+
+			sendAll(client, header, static_cast<size_t>(headerLength));
+			sendAll(client, body, bodyLength);
+			telemetryCloseSocket(client);
+		}
+	}
+
+	static void sendAll(TelemetrySocket client, const char* data, size_t size) {
+		while (size > 0) {
+			int sent = send(client, data, static_cast<int>(size), 0);
+			if (sent <= 0) return;
+			data += sent;
+			size -= static_cast<size_t>(sent);
+		}
+	}
+
+	const Telemetry& telemetry;
+	TelemetrySocket listener = TELEMETRY_INVALID_SOCKET;
+	std::atomic<bool> running{ false };
+	std::thread worker;
+#ifdef _WIN32
+	bool wsaStarted = false;
+#endif
+
+	// Буферы фонового потока выделены заранее
+	char request[1024];
+	char header[256];
+	char body[8192];
+};
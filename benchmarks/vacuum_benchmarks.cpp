@@ -0,0 +1,398 @@
+// Набор бенчмарков симулятора (Google Benchmark).
+//
+//   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target vacuum_benchmarks
+//   build/vacuum_benchmarks --benchmark_out=results.json --benchmark_out_format=json
+//   python3 tools/compare_benchmarks.py benchmarks/baseline.json results.json
+//
+// или всё сразу: cmake --build build --target benchmark_check
+//
+// Сценарии воспроизводимы: мусор расставляется с фиксированным зерном, робот в
+// эпизодах ездит по детерминированной траектории.
+//   BM_CollisionCheck/N   — проверка столкновений с N единицами мусора (робот над полом, без подбора)
+//   BM_Episode/N          — эпизод целиком, до разряда батареи или сбора всего мусора (-1 — как в уровне)
+//   BM_TextureDecode/i    — декодирование JPEG текстуры уровня (stb_image)
+//   BM_TextureLoad/i      — декодирование, загрузка в GPU и мипмапы (loadTexture)
+//   BM_ShaderCompile/p    — компиляция и линковка программ приложения
+//   BM_RenderFrame/W/H    — кадр сцены в offscreen-буфер заданного разрешения
+//
+// Сценарии OpenGL используют скрытое окно GLFW. Если контекст создать нельзя
+// (нет дисплея), они пропускаются с ошибкой, а не завершают прогон.
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Simulation.h"
+#include "Shaders.h"
+#include "Texture.h"
+#include "MeshRegistry.h"
+#include "GpuDebris.h"
+
+// Каталог с уровнями и текстурами (OpenGL/ в исходниках, задаётся CMake)
+#ifndef VACUUM_ASSET_DIR
+#define VACUUM_ASSET_DIR "."
+#endif
+
+const unsigned int benchmarkSeed = 12345;
+
+std::string assetPath(const char* relative) {
+	return std::string(VACUUM_ASSET_DIR) + "/" + relative;
+}
+
+// Уровень открывается один раз на весь прогон
+bool ensureLevel(benchmark::State& state) {
+	if (level.memory) return true;
+	if (!openLevelFile(level, assetPath("levels/default.vclevel").c_str())) {
+		state.SkipWithError("cannot open levels/default.vclevel");
+		return false;
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// Симуляция
+
+void BM_CollisionCheck(benchmark::State& state) {
+	if (!ensureLevel(state)) return;
+	spawnSeed = benchmarkSeed;
+	objects.clear();
+	generateObjects(static_cast<int>(state.range(0)));
+	robotPosition = glm::vec3(0.0f, 10.0f, 0.0f);
+
+	for (auto _ : state) {
+		checkCollisions();
+		benchmark::DoNotOptimize(objects.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CollisionCheck)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Траектория как у простого пылесоса: прямо до стены или препятствия, затем
+// поворот на bounceDegrees (не делитель 360, чтобы робот не ходил по кругу)
+const float bounceDegrees = 137.0f;
+
+void BM_Episode(benchmark::State& state) {
+	if (!ensureLevel(state)) return;
+	spawnSeed = benchmarkSeed;
+	int debrisCount = static_cast<int>(state.range(0));
+	float bounceCos = std::cos(glm::radians(bounceDegrees));
+	float bounceSin = std::sin(glm::radians(bounceDegrees));
+	int64_t ticks = 0;
+	int64_t collected = 0;
+
+	for (auto _ : state) {
+		robotPosition = glm::vec3(0.0f, 0.5f, 0.0f);
+		robotDirection = glm::vec3(0.0f, 0.0f, -1.0f);
+		resetEpisode(debrisCount);
+
+		EpisodeState episodeState = EpisodeState::Running;
+		while (episodeState == EpisodeState::Running) {
+			glm::vec3 previousPosition = robotPosition;
+			episodeState = stepSimulation();
+			removedDebris.clear();
+			++ticks;
+			if (robotPosition == previousPosition) {
+				robotDirection = glm::vec3(bounceCos * robotDirection.x + bounceSin * robotDirection.z, 0.0f,
+					-bounceSin * robotDirection.x + bounceCos * robotDirection.z);
+			}
+		}
+		collected += score;
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.counters["ticks_per_episode"] = static_cast<double>(ticks) / state.iterations();
+	state.counters["collected_per_episode"] = static_cast<double>(collected) / state.iterations();
+	state.counters["ticks_per_second"] = benchmark::Counter(static_cast<double>(ticks), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Episode)->Arg(-1)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// Текстуры
+
+const char* texturePathByIndex(benchmark::State& state) {
+	if (!ensureLevel(state)) return nullptr;
+	size_t index = static_cast<size_t>(state.range(0));
+	if (index >= level.textures.size()) {
+		state.SkipWithError("level has no such texture");
+		return nullptr;
+	}
+	return level.textures[index].path;
+}
+
+void BM_TextureDecode(benchmark::State& state) {
+	const char* name = texturePathByIndex(state);
+	if (!name) return;
+	std::string path = assetPath(name);
+	state.SetLabel(name);
+
+	int64_t bytes = 0;
+	for (auto _ : state) {
+		int width, height, channels;
+		stbi_set_flip_vertically_on_load(true);
+		unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		if (!data) {
+			state.SkipWithError("cannot decode texture");
+			return;
+		}
+		bytes += static_cast<int64_t>(width) * height * channels;
+		stbi_image_free(data);
+	}
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_TextureDecode)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// ---------------------------------------------------------------------------
+// OpenGL
+
+// Скрытое окно GLFW; создаётся при первом сценарии, которому нужен контекст
+GLFWwindow* benchmarkWindow = nullptr;
+bool glContextFailed = false;
+
+bool ensureGlContext(benchmark::State& state) {
+	if (benchmarkWindow) return true;
+	if (!glContextFailed) {
+		glContextFailed = true;
+		if (glfwInit()) {
+			glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+			benchmarkWindow = glfwCreateWindow(64, 64, "Vacuum Cleaner Benchmarks", nullptr, nullptr);
+		}
+		if (benchmarkWindow) {
+			glfwMakeContextCurrent(benchmarkWindow);
+			glContextFailed = !gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+		}
+	}
+	if (glContextFailed) {
+		state.SkipWithError("no OpenGL context");
+		return false;
+	}
+	return true;
+}
+
+void BM_TextureLoad(benchmark::State& state) {
+	const char* name = texturePathByIndex(state);
+	if (!name || !ensureGlContext(state)) return;
+	std::string path = assetPath(name);
+	state.SetLabel(name);
+
+	for (auto _ : state) {
+		unsigned int texture = loadTexture(path.c_str());
+		glFinish();
+		glDeleteTextures(1, &texture);
+	}
+}
+BENCHMARK(BM_TextureLoad)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Программы приложения в порядке аргумента BM_ShaderCompile
+enum BenchmarkProgram {
+	SceneProgram,
+	MultiDrawProgram,
+	DebrisCullProgram,
+	ShadowProgram,
+	UiProgram
+};
+
+void BM_ShaderCompile(benchmark::State& state) {
+	if (!ensureGlContext(state)) return;
+	int programIndex = static_cast<int>(state.range(0));
+	std::string multiDrawFragmentSource = replaceShaderVersion(fragmentShaderSource, "#version 430 core");
+	const char* labels[] = { "scene", "multi-draw", "debris cull", "shadow", "ui" };
+	state.SetLabel(labels[programIndex]);
+
+	if ((programIndex == MultiDrawProgram && !multiDrawIndirectAvailable()) ||
+		(programIndex == DebrisCullProgram && !gpuDebrisComputeAvailable())) {
+		state.SkipWithError("GL 4.3 is not available");
+		return;
+	}
+
+	for (auto _ : state) {
+		unsigned int program = 0;
+		switch (programIndex) {
+		case SceneProgram:
+			program = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+			break;
+		case MultiDrawProgram:
+			program = createShaderProgram(multiDrawVertexShaderSource, multiDrawFragmentSource.c_str());
+			break;
+		case DebrisCullProgram:
+			program = createComputeProgram(debrisCullComputeShaderSource);
+			break;
+		case ShadowProgram:
+			program = createShaderProgram(shadowVertexShaderSource, shadowFragmentShaderSource);
+			break;
+		default:
+			program = createShaderProgram(uiVertexShaderSource, uiFragmentShaderSource);
+			break;
+		}
+		if (!program) {
+			state.SkipWithError("program failed to link");
+			return;
+		}
+		glDeleteProgram(program);
+	}
+}
+BENCHMARK(BM_ShaderCompile)->DenseRange(SceneProgram, UiProgram)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+const char* meshTexturePath(const char* meshName) {
+	const LevelMesh* mesh = findLevelMesh(level, meshName);
+	return mesh && mesh->texture >= 0 ? level.textures[mesh->texture].path : "";
+}
+
+MeshHandle addBenchmarkMesh(MeshRegistry& registry, const char* name) {
+	const LevelMesh& mesh = *findLevelMesh(level, name);
+	return registry.add(level.vertices[mesh.firstVertex].position, mesh.vertexCount, MeshRegistry::floatsPerVertex,
+		reinterpret_cast<const unsigned int*>(level.indices.data + mesh.firstIndex), mesh.indexCount);
+}
+
+// Кадр основного прохода: пол, стена, зеркало и мусор из буфера GPU тем же
+// шейдером, что и в приложении, в offscreen-буфер width x height. Отражение и
+// тени не рисуются: у них свои разрешения, не зависящие от размера кадра.
+const int renderDebrisCount = 1000;
+
+void BM_RenderFrame(benchmark::State& state) {
+	if (!ensureLevel(state) || !ensureGlContext(state)) return;
+	int width = static_cast<int>(state.range(0));
+	int height = static_cast<int>(state.range(1));
+
+	unsigned int program = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+	if (!program) {
+		state.SkipWithError("scene program failed to link");
+		return;
+	}
+
+	MeshRegistry registry;
+	MeshHandle floor = addBenchmarkMesh(registry, "floor");
+	MeshHandle wall = addBenchmarkMesh(registry, "wall");
+	MeshHandle mirror = addBenchmarkMesh(registry, "mirror");
+	MeshHandle cube = addBenchmarkMesh(registry, "cube");
+	registry.upload();
+
+	spawnSeed = benchmarkSeed;
+	objects.clear();
+	generateObjects(renderDebrisCount);
+	GpuDebris debris;
+	unsigned int cullProgram = gpuDebrisComputeAvailable() ? createComputeProgram(debrisCullComputeShaderSource) : 0;
+	createGpuDebris(debris, registry, objects.size(), cullProgram);
+	uploadGpuDebris(debris, objects.data(), objects.size(), debrisScale);
+
+	unsigned int floorTexture = loadTexture(assetPath(meshTexturePath("floor")).c_str());
+	unsigned int wallTexture = loadTexture(assetPath(meshTexturePath("wall")).c_str());
+	unsigned int fbo, colorBuffer, depthBuffer;
+	glGenFramebuffers(1, &fbo);
+	glGenRenderbuffers(1, &colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+	// Камера и прожектор как в приложении: робот в центре, камера сзади и сверху
+	glm::vec3 robot(0.0f, 0.5f, 0.0f);
+	glm::vec3 eye = robot + glm::vec3(0.0f, 10.0f, 5.0f);
+	glm::mat4 view = glm::lookAt(eye, robot, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(width) / height, 0.1f, 100.0f);
+	glm::mat4 model(1.0f);
+	// Все экземпляры видимы — худший случай для отсечения
+	glm::vec4 planes[6];
+	for (glm::vec4& plane : planes) plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	setupSamplerUniforms(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+	glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+	glUniformMatrix4fv(glGetUniformLocation(program, "model"), 1, GL_FALSE, glm::value_ptr(model));
+	glUniform3f(glGetUniformLocation(program, "viewPos"), eye.x, eye.y, eye.z);
+	glUniform3f(glGetUniformLocation(program, "lightPos"), robot.x, robot.y, robot.z);
+	glUniform3f(glGetUniformLocation(program, "lightDir"), 0.0f, -0.3f, -1.0f);
+	glUniform3f(glGetUniformLocation(program, "lightColor"), 1.0f, 1.0f, 1.0f);
+	glUniform1f(glGetUniformLocation(program, "cutOff"), glm::cos(glm::radians(55.0f)));
+	glUniform1f(glGetUniformLocation(program, "outerCutOff"), glm::cos(glm::radians(70.0f)));
+	size_t lamps = std::min<size_t>(level.lamps.size(), 8);
+	glUniform1i(glGetUniformLocation(program, "lampCount"), static_cast<int>(lamps));
+	char name[64];
+	for (size_t i = 0; i < lamps; ++i) {
+		std::snprintf(name, sizeof(name), "lampPositions[%zu]", i);
+		glUniform3fv(glGetUniformLocation(program, name), 1, level.lamps[i].position);
+		std::snprintf(name, sizeof(name), "lampColors[%zu]", i);
+		glUniform3fv(glGetUniformLocation(program, name), 1, level.lamps[i].color);
+	}
+	GLint materialLoc = glGetUniformLocation(program, "material");
+	GLint instancedLoc = glGetUniformLocation(program, "instanced");
+
+	// Блоки как в приложении (setupSamplerUniforms); карта и текстура отражений и атлас теней не
+	// используются, их блоки остаются пустыми
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, wallTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, floorTexture);
+	glViewport(0, 0, width, height);
+	glEnable(GL_DEPTH_TEST);
+
+	bool firstFrame = true;
+	for (auto _ : state) {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glUseProgram(program);
+		registry.bind();
+		glUniform4f(materialLoc, 0.0f, 0.0f, 0.0f, 0.0f);
+		registry.draw(floor);
+		glUniform4f(materialLoc, 1.0f, 0.0f, 0.0f, 0.0f);
+		registry.draw(wall);
+		registry.draw(mirror);
+		glUniform1i(instancedLoc, 1);
+		drawGpuDebris(debris, registry, cube, planes, program);
+		glUniform1i(instancedLoc, 0);
+		glFinish();
+		// Без этой проверки сломанные отрисовки замерялись бы как glClear + glFinish
+		if (firstFrame) {
+			firstFrame = false;
+			GLenum error = glGetError();
+			if (error != GL_NO_ERROR) {
+				char message[64];
+				std::snprintf(message, sizeof(message), "GL error 0x%04X in the first frame", error);
+				state.SkipWithError(message);
+				break;
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetLabel(debris.computeCulling ? "compute culling" : "GL 3.3 instanced");
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteTextures(1, &floorTexture);
+	glDeleteTextures(1, &wallTexture);
+	deleteGpuDebris(debris);
+	registry.release();
+	glDeleteProgram(program);
+}
+BENCHMARK(BM_RenderFrame)->Args({ 640, 360 })->Args({ 1280, 720 })->Args({ 1920, 1080 })
+	->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv) {
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	if (benchmarkWindow) {
+		glfwDestroyWindow(benchmarkWindow);
+	}
+	glfwTerminate();
+	closeLevelFile(level);
+	return 0;
+}
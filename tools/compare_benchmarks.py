@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Compare benchmark results against a stored baseline.
+
+    build/vacuum_benchmarks --benchmark_out=results.json --benchmark_out_format=json
+    python3 tools/compare_benchmarks.py benchmarks/baseline.json results.json [--threshold 0.15]
+    python3 tools/compare_benchmarks.py benchmarks/baseline.json results.json --update
+
+results.json is Google Benchmark JSON output. With --benchmark_repetitions the
+median aggregate is compared, otherwise the mean of the iteration runs. Times
+are real (wall-clock) times in nanoseconds.
+
+The baseline holds the reference times and the allowed slowdown:
+    {
+      "default_threshold": 0.15,
+      "thresholds": {"BM_RenderFrame/*": 0.30},
+      "benchmarks": {"BM_CollisionCheck/1000": {"real_time_ns": 410.0}}
+    }
+Threshold patterns are fnmatch patterns; the first match wins. A benchmark
+slower than baseline * (1 + threshold) is a regression and the script exits 1.
+Baseline benchmarks that were skipped (e.g. no OpenGL context) or not run are
+reported but do not fail the run unless --fail-on-missing is given.
+A result without a baseline entry, or a missing or empty baseline, fails the
+run: such a benchmark is not gated at all. --allow-unrecorded only reports it,
+for machines where the baseline has not been recorded yet.
+--update rewrites the baseline times from the results and keeps thresholds.
+"""
+import argparse
+import fnmatch
+import json
+import sys
+
+TIME_UNITS_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load_json(path):
+    with open(path, encoding="utf-8") as f:
+        return json.load(f)
+
+
+def collect_results(results):
+    """Real time in ns per benchmark run name; None for skipped benchmarks."""
+    runs = {}
+    medians = {}
+    for entry in results.get("benchmarks", []):
+        name = entry.get("run_name", entry["name"])
+        if entry.get("error_occurred"):
+            runs.setdefault(name, None)
+            continue
+        time_ns = entry["real_time"] * TIME_UNITS_NS[entry.get("time_unit", "ns")]
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[name] = time_ns
+            continue
+        if runs.get(name) is None:
+            runs[name] = []
+        runs[name].append(time_ns)
+    times = {}
+    for name, samples in runs.items():
+        times[name] = sum(samples) / len(samples) if samples else None
+    times.update(medians)
+    return times
+
+
+def threshold_for(name, baseline, override):
+    if override is not None:
+        return override
+    for pattern, threshold in baseline.get("thresholds", {}).items():
+        if fnmatch.fnmatchcase(name, pattern):
+            return threshold
+    return baseline.get("default_threshold", 0.15)
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return "%.3f %s" % (value / scale, unit)
+    return "%.1f ns" % value
+
+
+def compare(baseline, times, override, fail_on_missing, allow_unrecorded):
+    regressions = 0
+    missing = 0
+    unrecorded = 0
+    reference = baseline.get("benchmarks", {})
+    width = max([len(name) for name in list(reference) + list(times)] + [10])
+    for name in sorted(set(reference) | set(times)):
+        current = times.get(name)
+        if name not in reference:
+            status = "skipped"
+            if current is not None:
+                unrecorded += 1
+                status = "no baseline" if allow_unrecorded else "NO BASELINE"
+            print("%-*s  %12s  %12s  %s" % (width, name, "-", format_ns(current) if current else "-", status))
+            continue
+        expected = reference[name]["real_time_ns"]
+        if current is None:
+            missing += 1
+            print("%-*s  %12s  %12s  %s" % (width, name, format_ns(expected), "-",
+                "skipped" if name in times else "missing"))
+            continue
+        threshold = threshold_for(name, baseline, override)
+        change = current / expected - 1.0
+        if change > threshold:
+            regressions += 1
+            status = "REGRESSION (%+.1f%%, limit %+.1f%%)" % (change * 100.0, threshold * 100.0)
+        else:
+            status = "ok (%+.1f%%)" % (change * 100.0)
+        print("%-*s  %12s  %12s  %s" % (width, name, format_ns(expected), format_ns(current), status))
+
+    print()
+    print("%d regression(s), %d benchmark(s) without results, %d without baseline" % (regressions, missing, unrecorded))
+    if not reference:
+        print("The baseline is empty. Record it with --update.")
+    failed = regressions > 0 or (fail_on_missing and missing > 0)
+    if not allow_unrecorded and (unrecorded > 0 or not reference):
+        failed = True
+    return failed
+
+
+def update(baseline_path, baseline, times):
+    reference = baseline.setdefault("benchmarks", {})
+    for name, current in times.items():
+        if current is not None:
+            reference[name] = {"real_time_ns": round(current, 1)}
+    baseline["benchmarks"] = dict(sorted(reference.items()))
+    with open(baseline_path, "w", encoding="utf-8") as f:
+        json.dump(baseline, f, indent=2)
+        f.write("\n")
+    print("Updated %d baseline entries in %s" % (sum(1 for t in times.values() if t is not None), baseline_path))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("results")
+    parser.add_argument("--threshold", type=float, default=None,
+        help="allowed slowdown for every benchmark, overrides the baseline thresholds")
+    parser.add_argument("--fail-on-missing", action="store_true",
+        help="also fail if a baseline benchmark was skipped or not run")
+    parser.add_argument("--allow-unrecorded", action="store_true",
+        help="only report results without a baseline entry (and a missing or empty baseline)")
+    parser.add_argument("--update", action="store_true", help="write the results into the baseline")
+    args = parser.parse_args()
+
+    try:
+        baseline = load_json(args.baseline)
+    except FileNotFoundError:
+        if not (args.update or args.allow_unrecorded):
+            print("No baseline at %s. Record it with --update." % args.baseline)
+            return 1
+        baseline = {}
+    times = collect_results(load_json(args.results))
+    if args.update:
+        update(args.baseline, baseline, times)
+        return 0
+    return 1 if compare(baseline, times, args.threshold, args.fail_on_missing, args.allow_unrecorded) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
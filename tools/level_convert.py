@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""Convert a JSON level description into the binary .vclevel format.
+
+    python3 tools/level_convert.py OpenGL/levels/default.json OpenGL/levels/default.vclevel
+
+--random-debris N adds N fixed debris positions inside the first spawn area
+(or the floor if there is none), e.g. to build the 1M-debris load benchmark:
+
+    python3 tools/level_convert.py OpenGL/levels/default.json /tmp/debris-1m.vclevel --random-debris 1000000
+
+The binary layout is documented in OpenGL/LevelFormat.h; keep both in sync.
+"""
+import argparse
+import json
+import random
+import struct
+import sys
+from array import array
+
+LEVEL_MAGIC = 0x4C564356
+LEVEL_VERSION = 1
+
+SECTION_VERTICES = 1
+SECTION_INDICES = 2
+SECTION_MESHES = 3
+SECTION_LAMPS = 4
+SECTION_OBSTACLES = 5
+SECTION_DEBRIS_SPAWNS = 6
+SECTION_DEBRIS = 7
+SECTION_TEXTURES = 8
+
+HEADER = struct.Struct("<IIIIQ")
+SECTION_ENTRY = struct.Struct("<IIQQ")
+MESH = struct.Struct("<32sIIIIi12x")
+LAMP = struct.Struct("<3f3f")
+OBSTACLE = struct.Struct("<3f3f")
+DEBRIS_SPAWN = struct.Struct("<3f3fIf")
+DEBRIS = struct.Struct("<3f")
+TEXTURE = struct.Struct("<128s")
+
+
+def fail(message):
+    sys.exit("level_convert: " + message)
+
+
+def vec3(value, what):
+    if not isinstance(value, list) or len(value) != 3:
+        fail("%s must be [x, y, z]" % what)
+    return [float(v) for v in value]
+
+
+def encode_name(text, size, what):
+    data = text.encode("utf-8")
+    if len(data) >= size:
+        fail("%s '%s' is longer than %d bytes" % (what, text, size - 1))
+    return data
+
+
+def build_sections(level, random_debris, seed):
+    textures = level.get("textures", [])
+    vertices = array("f")
+    indices = array("I")
+    meshes = bytearray()
+    for mesh in level.get("meshes", []):
+        name = mesh.get("name")
+        if not name:
+            fail("mesh without a name")
+        stride = int(mesh.get("stride", 8))
+        if stride not in (6, 8):
+            fail("mesh '%s': stride must be 6 (position, normal) or 8 (position, normal, uv)" % name)
+        data = mesh.get("vertices", [])
+        if len(data) % stride:
+            fail("mesh '%s': vertex data is not a multiple of the stride" % name)
+        vertex_count = len(data) // stride
+        mesh_indices = mesh.get("indices", list(range(vertex_count)))
+        if any(i < 0 or i >= vertex_count for i in mesh_indices):
+            fail("mesh '%s': index out of range" % name)
+        texture = mesh.get("texture", -1)
+        if isinstance(texture, str):
+            if texture not in textures:
+                fail("mesh '%s': unknown texture '%s'" % (name, texture))
+            texture = textures.index(texture)
+        if not -1 <= texture < len(textures):
+            fail("mesh '%s': texture index out of range" % name)
+
+        first_vertex = len(vertices) // 8
+        for v in range(vertex_count):
+            row = data[v * stride:(v + 1) * stride]
+            vertices.extend(float(x) for x in row)
+            if stride == 6:
+                vertices.extend((0.0, 0.0))
+        first_index = len(indices)
+        indices.extend(mesh_indices)
+        meshes += MESH.pack(encode_name(name, 32, "mesh name"), first_vertex, vertex_count,
+                            first_index, len(mesh_indices), texture)
+
+    lamps = bytearray()
+    for lamp in level.get("lamps", []):
+        lamps += LAMP.pack(*vec3(lamp["position"], "lamp position"),
+                           *vec3(lamp.get("color", [1.0, 1.0, 1.0]), "lamp color"))
+
+    obstacles = bytearray()
+    for obstacle in level.get("obstacles", []):
+        obstacles += OBSTACLE.pack(*vec3(obstacle["min"], "obstacle min"), *vec3(obstacle["max"], "obstacle max"))
+
+    spawns = level.get("debrisSpawns", [])
+    debris_spawns = bytearray()
+    for spawn in spawns:
+        debris_spawns += DEBRIS_SPAWN.pack(*vec3(spawn["min"], "spawn min"), *vec3(spawn["max"], "spawn max"),
+                                           int(spawn.get("count", 0)), float(spawn.get("gridStep", 0.0)))
+
+    debris = array("f")
+    for position in level.get("debris", []):
+        debris.extend(vec3(position, "debris position"))
+    if random_debris:
+        area = spawns[0] if spawns else {"min": [-9.0, 0.2, -9.0], "max": [9.0, 0.2, 9.0]}
+        low, high = vec3(area["min"], "spawn min"), vec3(area["max"], "spawn max")
+        rng = random.Random(seed)
+        for _ in range(random_debris):
+            debris.extend((rng.uniform(low[0], high[0]), rng.uniform(low[1], high[1]), rng.uniform(low[2], high[2])))
+
+    texture_data = bytearray()
+    for path in textures:
+        texture_data += TEXTURE.pack(encode_name(path, 128, "texture path"))
+
+    if sys.byteorder != "little":
+        vertices.byteswap()
+        indices.byteswap()
+        debris.byteswap()
+
+    return [
+        (SECTION_VERTICES, 32, len(vertices) // 8, vertices.tobytes()),
+        (SECTION_INDICES, 4, len(indices), indices.tobytes()),
+        (SECTION_MESHES, MESH.size, len(meshes) // MESH.size, bytes(meshes)),
+        (SECTION_LAMPS, LAMP.size, len(lamps) // LAMP.size, bytes(lamps)),
+        (SECTION_OBSTACLES, OBSTACLE.size, len(obstacles) // OBSTACLE.size, bytes(obstacles)),
+        (SECTION_DEBRIS_SPAWNS, DEBRIS_SPAWN.size, len(debris_spawns) // DEBRIS_SPAWN.size, bytes(debris_spawns)),
+        (SECTION_DEBRIS, DEBRIS.size, len(debris) // 3, debris.tobytes()),
+        (SECTION_TEXTURES, TEXTURE.size, len(texture_data) // TEXTURE.size, bytes(texture_data)),
+    ]
+
+
+def align(offset):
+    return (offset + 7) & ~7
+
+
+def write_level(path, sections):
+    offset = align(HEADER.size + SECTION_ENTRY.size * len(sections))
+    table = bytearray()
+    layout = []
+    for kind, element_size, count, data in sections:
+        table += SECTION_ENTRY.pack(kind, element_size, offset, count)
+        layout.append((offset, data))
+        offset = align(offset + len(data))
+    file_size = offset
+
+    with open(path, "wb") as out:
+        out.write(HEADER.pack(LEVEL_MAGIC, LEVEL_VERSION, len(sections), 0, file_size))
+        out.write(table)
+        for section_offset, data in layout:
+            out.write(b"\0" * (section_offset - out.tell()))
+            out.write(data)
+        out.write(b"\0" * (file_size - out.tell()))
+    return file_size
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="JSON level description")
+    parser.add_argument("output", help="binary .vclevel file")
+    parser.add_argument("--random-debris", type=int, default=0, help="add N random fixed debris positions")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    with open(args.input, encoding="utf-8") as source:
+        level = json.load(source)
+    if level.get("version", LEVEL_VERSION) != LEVEL_VERSION:
+        fail("unsupported JSON level version %s" % level.get("version"))
+
+    sections = build_sections(level, args.random_debris, args.seed)
+    size = write_level(args.output, sections)
+    counts = {kind: count for kind, _, count, _ in sections}
+    print("%s: %d bytes, %d meshes, %d lamps, %d obstacles, %d spawn areas, %d fixed debris" % (
+        args.output, size, counts[SECTION_MESHES], counts[SECTION_LAMPS], counts[SECTION_OBSTACLES],
+        counts[SECTION_DEBRIS_SPAWNS], counts[SECTION_DEBRIS]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
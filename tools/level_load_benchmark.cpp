@@ -0,0 +1,77 @@
+// Время загрузки бинарного уровня (.vclevel).
+//
+//   python3 tools/level_convert.py OpenGL/levels/default.json /tmp/debris-1m.vclevel --random-debris 1000000
+//   g++ -O2 -std=c++17 -I OpenGL tools/level_load_benchmark.cpp -o level_load_benchmark
+//   ./level_load_benchmark /tmp/debris-1m.vclevel [iterations]
+//
+// Для каждой итерации измеряется:
+//   open  — mmap, проверка заголовка, границ секций и ссылок мешей;
+//   touch — первое чтение всех позиций мусора (подкачка страниц);
+//   copy  — копирование мусора в std::vector<float[3]>, как generateObjects
+//           делает для подбираемого мусора.
+
+#include "LevelFormat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+struct DebrisPosition {
+	float x, y, z;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " level.vclevel [iterations]" << std::endl;
+		return 2;
+	}
+	int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+	std::vector<double> openMs, touchMs, copyMs;
+	std::vector<DebrisPosition> objects;
+	size_t debrisCount = 0;
+	size_t fileSize = 0;
+	double checksum = 0.0;
+
+	for (int i = 0; i < iterations; ++i) {
+		LevelFile level;
+		auto start = std::chrono::steady_clock::now();
+		if (!openLevelFile(level, argv[1])) {
+			return 1;
+		}
+		openMs.push_back(elapsedMs(start));
+
+		start = std::chrono::steady_clock::now();
+		for (const LevelDebris& debris : level.debris) {
+			checksum += debris.position[0];
+		}
+		touchMs.push_back(elapsedMs(start));
+
+		start = std::chrono::steady_clock::now();
+		const DebrisPosition* positions = reinterpret_cast<const DebrisPosition*>(level.debris.data);
+		objects.assign(positions, positions + level.debris.size());
+		copyMs.push_back(elapsedMs(start));
+
+		debrisCount = level.debris.size();
+		fileSize = level.size;
+		closeLevelFile(level);
+	}
+
+	auto report = [](const char* name, std::vector<double>& samples) {
+		std::sort(samples.begin(), samples.end());
+		std::cout << "  " << name << ": min " << samples.front() << " ms, median " << samples[samples.size() / 2]
+			<< " ms, max " << samples.back() << " ms" << std::endl;
+	};
+	std::cout << argv[1] << ": " << fileSize << " bytes, " << debrisCount << " fixed debris, "
+		<< iterations << " iterations (checksum " << checksum << ")" << std::endl;
+	report("open ", openMs);
+	report("touch", touchMs);
+	report("copy ", copyMs);
+	return 0;
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""Start the simulator with the Prometheus endpoint and scrape it.
+
+    python3 tools/metrics_check.py build/vacuum_cleaner [--port 9464] [--startup-timeout 30]
+
+Runs the simulator with --metrics-port PORT (and any extra arguments after --),
+waits for /metrics to answer, runs tools/scrape_metrics.py against it and stops
+the simulator. Exits with the scraper's status, or 1 if the simulator exits or
+the endpoint does not come up. Registered as the metrics_scrape ctest.
+"""
+import argparse
+import os
+import subprocess
+import sys
+import time
+import urllib.request
+
+SCRAPER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "scrape_metrics.py")
+
+
+def wait_for_endpoint(app, port, timeout):
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if app.poll() is not None:
+            print("FAIL: simulator exited with code %d before the endpoint came up" % app.returncode)
+            return False
+        try:
+            with urllib.request.urlopen("http://127.0.0.1:%d/metrics" % port, timeout=1):
+                return True
+        except OSError:
+            time.sleep(0.2)
+    print("FAIL: no answer on port %d after %.0f s" % (port, timeout))
+    return False
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("simulator")
+    parser.add_argument("--port", type=int, default=9464)
+    parser.add_argument("--startup-timeout", type=float, default=30.0)
+    parser.add_argument("app_args", nargs=argparse.REMAINDER, help="extra simulator arguments after --")
+    args = parser.parse_args()
+    extra = args.app_args[1:] if args.app_args[:1] == ["--"] else args.app_args
+
+    app = subprocess.Popen([args.simulator, "--metrics-port", str(args.port)] + extra)
+    try:
+        if not wait_for_endpoint(app, args.port, args.startup_timeout):
+            return 1
+        status = subprocess.call([sys.executable, SCRAPER, "--port", str(args.port)])
+        if app.poll() is not None:
+            print("FAIL: simulator exited with code %d during the scrape" % app.returncode)
+            return 1
+        return status
+    finally:
+        if app.poll() is None:
+            app.terminate()
+            try:
+                app.wait(timeout=10)
+            except subprocess.TimeoutExpired:
+                app.kill()
+                app.wait()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Scrape the simulator's Prometheus endpoint and sanity-check the metrics.
+
+Run the simulator with --metrics-port PORT, then:
+    python3 tools/scrape_metrics.py [--port 9464] [--count 3] [--interval 1.0]
+Exits non-zero if a metric is missing or a counter goes backwards.
+"""
+import argparse
+import sys
+import time
+import urllib.request
+
+REQUIRED = [
+    "vacuum_frames_total",
+    "vacuum_sim_ticks_total",
+    "vacuum_draw_calls_total",
+    "vacuum_pickups_total",
+    "vacuum_episodes_total",
+    "vacuum_sim_ticks_per_second",
+    "vacuum_frame_draw_calls",
+    "vacuum_debris_remaining",
+    "vacuum_battery_percent",
+    "vacuum_coverage_ratio",
+    "vacuum_frame_time_ms_sum",
+    "vacuum_frame_time_ms_count",
+]
+COUNTERS = [name for name in REQUIRED if name.endswith("_total")] + ["vacuum_frame_time_ms_count"]
+
+
+def scrape(port):
+    with urllib.request.urlopen("http://127.0.0.1:%d/metrics" % port, timeout=2) as response:
+        text = response.read().decode("utf-8")
+    samples = {}
+    for line in text.splitlines():
+        if not line or line.startswith("#"):
+            continue
+        name, value = line.rsplit(" ", 1)
+        samples[name] = float(value)
+    return samples
+
+
+def check(samples):
+    errors = ["missing %s" % name for name in REQUIRED if name not in samples]
+    buckets = [value for name, value in samples.items() if name.startswith("vacuum_frame_time_ms_bucket")]
+    if buckets != sorted(buckets):
+        errors.append("frame time buckets are not cumulative")
+    if buckets and buckets[-1] != samples.get("vacuum_frame_time_ms_count"):
+        errors.append("+Inf bucket does not match count")
+    coverage = samples.get("vacuum_coverage_ratio", 0.0)
+    if not 0.0 <= coverage <= 1.0:
+        errors.append("coverage out of range: %g" % coverage)
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--port", type=int, default=9464)
+    parser.add_argument("--count", type=int, default=3)
+    parser.add_argument("--interval", type=float, default=1.0)
+    args = parser.parse_args()
+
+    previous = None
+    failed = False
+    for i in range(args.count):
+        samples = scrape(args.port)
+        errors = check(samples)
+        if previous is not None:
+            errors += ["%s went backwards" % name for name in COUNTERS
+                       if samples.get(name, 0.0) < previous.get(name, 0.0)]
+        for error in errors:
+            print("FAIL:", error)
+        failed = failed or bool(errors)
+        print("scrape %d: frames=%d ticks/s=%.1f pickups=%d battery=%.1f%% coverage=%.2f" % (
+            i + 1, samples.get("vacuum_frames_total", 0), samples.get("vacuum_sim_ticks_per_second", 0),
+            samples.get("vacuum_pickups_total", 0), samples.get("vacuum_battery_percent", 0),
+            samples.get("vacuum_coverage_ratio", 0)))
+        previous = samples
+        if i + 1 < args.count:
+            time.sleep(args.interval)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())